@@ -1,11 +1,63 @@
 #ifndef NTH_ALGORITHM_TREE_INTERNAL_TREE_H
 #define NTH_ALGORITHM_TREE_INTERNAL_TREE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace nth::internal_algorithm {
 
-struct enter_subtree_tag {};
-struct enter_last_child_tag {};
-struct exit_subtree_tag {};
+// Each entry on a `tree_traversal_stack` is either a node or one of the markers
+// indicating that a traverser hook is to be invoked.
+enum class stack_tag : uint8_t {
+  node             = 0,
+  enter_subtree    = 1,
+  enter_last_child = 2,
+  exit_subtree     = 3,
+};
+
+// A stack of `stack_tag`s, packed two bits to a tag. Popping never releases
+// memory, so that a stack which is cleared and reused does not allocate.
+struct packed_tag_stack {
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+  [[nodiscard]] size_t size() const { return size_; }
+
+  stack_tag get(size_t n) const {
+    return static_cast<stack_tag>((words_[n / TagsPerWord] >> Shift(n)) & 3);
+  }
+
+  void set(size_t n, stack_tag tag) {
+    uint64_t& word = words_[n / TagsPerWord];
+    word = (word & ~(uint64_t{3} << Shift(n))) |
+           (static_cast<uint64_t>(tag) << Shift(n));
+  }
+
+  stack_tag back() const { return get(size_ - 1); }
+
+  void push(stack_tag tag) {
+    if (size_ / TagsPerWord == words_.size()) { words_.push_back(0); }
+    set(size_++, tag);
+  }
+
+  void pop() { --size_; }
+
+  // Removes the top `n` tags.
+  void pop(size_t n) { size_ -= n; }
+
+  void reserve(size_t n) {
+    words_.reserve((n + TagsPerWord - 1) / TagsPerWord);
+  }
+
+  void clear() { size_ = 0; }
+
+ private:
+  static constexpr size_t TagsPerWord = 32;
+
+  static constexpr size_t Shift(size_t n) { return 2 * (n % TagsPerWord); }
+
+  std::vector<uint64_t> words_;
+  size_t size_ = 0;
+};
 
 }  // namespace nth::internal_algorithm
 
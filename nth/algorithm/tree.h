@@ -1,10 +1,8 @@
 #ifndef NTH_ALGORITHM_TREE_H
 #define NTH_ALGORITHM_TREE_H
 
+#include <algorithm>
 #include <cstddef>
-#include <iostream>
-#include <span>
-#include <variant>
 #include <vector>
 
 #include "nth/algorithm/internal/tree.h"
@@ -15,33 +13,49 @@ namespace nth {
 
 // This header contains algorithms for tree traversal.
 // The primary function to use is `traverse_tree`, which accepts three
-// parameters. The first is a tag indicating if the traversal is `nth::preorder`
-// or `nth::postorder` (at the moment post-order traversal is not supported).
-// The second parameter is a reference to a traverser which is responsible for
-// dictating how the tree is traversed. The third argument is a
-// `tree_traversal_stack` which should be initialized with the nodes needing to
-// be traversed. On each traversed node in the tree, `NthTraverseTreeNode` will
-// be invoked with the traverser, the node, and a reference to the
-// `tree_traversal_stack`. Users must implement the `NthTraverseTreeNode`,
-// pushing onto the `tree_traversal_stack`, any nodes they wish to visit. Nodes
-// are visited in a depth-first manner. Specifically, the last node pushed onto
-// the stack will be visited first.
+// parameters. The first is a tag indicating if the traversal is
+// `nth::preorder`, `nth::postorder`, or `nth::breadth_first`. The second
+// parameter is a reference to a traverser which is responsible for dictating
+// how the tree is traversed. The third argument is a `tree_traversal_stack`
+// which should be initialized with the nodes needing to be traversed. The
+// stack may be passed as an rvalue, or as an lvalue in which case it is left
+// empty, but with its memory retained, so that it may be reused for another
+// traversal without allocating.
+//
+// For pre-order and breadth-first traversals, on each traversed node in the
+// tree, `NthTraverseTreeNode` will be invoked with the traverser, the node, and
+// a reference to the `tree_traversal_stack`. Users must implement the
+// `NthTraverseTreeNode`, pushing onto the `tree_traversal_stack`, any nodes
+// they wish to visit. In a pre-order traversal, nodes are visited in a
+// depth-first manner. Specifically, the last node pushed onto the stack will be
+// visited first. In a breadth-first traversal, all nodes at one depth are
+// visited before any node at the next depth, and siblings are visited in the
+// same order as in a pre-order traversal.
+//
+// For post-order traversals, a node's children must be known before the node
+// itself is visited, so the two are separated. When a node is first reached,
+// `NthTraverseTreeChildren` is invoked with the traverser, the node, and a
+// reference to the `tree_traversal_stack`, and must push any children of the
+// node to visit. After all such children have been visited,
+// `NthTraverseTreeNode` is invoked with just the traverser and the node.
 //
 // There are several optional functions traversal implementers may make
-// available. If `NthTraverseTreeEnterSubtree` is invocable with the traverser,
-// it will be called just before entering any non-empty subtree. Similarly, if
+// available for depth-first (i.e., pre-order or post-order) traversals. If
+// `NthTraverseTreeEnterSubtree` is invocable with the traverser, it will be
+// called just before entering any non-empty subtree. Similarly, if
 // `NthTraverseTreeExitSubtree` is invocable with the traverser, it will be
 // called just after exiting any non-empty subtree. Lastly, if
 // `NthTraverseTreeEnterLastChild` is invocable with the traverser, it will be
 // called just before traversing the last of any collection of children of a
 // node. If a node has exactly one child, the function will be called before
-// visiting this one child.
-//
-// TODO: Support postorder traversal.
+// visiting this one child. None of these functions are invoked by a
+// breadth-first traversal.
 struct preorder_traversal_tag {};
 inline constexpr preorder_traversal_tag preorder;
 struct postorder_traversal_tag {};
 inline constexpr postorder_traversal_tag postorder;
+struct breadth_first_traversal_tag {};
+inline constexpr breadth_first_traversal_tag breadth_first;
 
 // Forward declarations of symbols defined below.
 template <typename>
@@ -49,110 +63,262 @@ struct tree_traversal_stack;
 
 template <int&..., typename Traverser, typename NodeType>
 void traverse_tree(preorder_traversal_tag, Traverser&,
-                   tree_traversal_stack<NodeType>);
+                   tree_traversal_stack<NodeType>&);
+
+template <int&..., typename Traverser, typename NodeType>
+void traverse_tree(postorder_traversal_tag, Traverser&,
+                   tree_traversal_stack<NodeType>&);
+
+template <int&..., typename Traverser, typename NodeType>
+void traverse_tree(breadth_first_traversal_tag, Traverser&,
+                   tree_traversal_stack<NodeType>&);
+
+template <int&..., typename Tag, typename Traverser, typename NodeType>
+void traverse_tree(Tag, Traverser&, tree_traversal_stack<NodeType>&&);
 
 // Implementation
 
+// Nodes are held in a vector of their own. Interleaved with them on the stack
+// are markers indicating when to invoke the optional traverser hooks. Markers
+// occupy no space in the vector of nodes; instead, each entry on the stack,
+// node or marker, is described by a two-bit tag.
 template <typename T>
 struct tree_traversal_stack {
   using value_type       = T;
   tree_traversal_stack() = default;
 
-  [[nodiscard]] constexpr bool empty() const { return stack_.empty(); }
+  [[nodiscard]] constexpr bool empty() const { return tags_.empty(); }
 
-  void push(value_type const& v) { stack_.emplace_back(v); }
-  void push(value_type&& v) { stack_.emplace_back(NTH_MOVE(v)); }
+  void push(value_type const& v) {
+    nodes_.push_back(v);
+    tags_.push(internal_algorithm::stack_tag::node);
+  }
+  void push(value_type&& v) {
+    nodes_.push_back(NTH_MOVE(v));
+    tags_.push(internal_algorithm::stack_tag::node);
+  }
   void emplace(auto&&... args) {
-    stack_.emplace_back(std::in_place_index<0>, NTH_FWD(args)...);
+    nodes_.emplace_back(NTH_FWD(args)...);
+    tags_.push(internal_algorithm::stack_tag::node);
+  }
+
+  // Ensures that `n` nodes may be pushed without allocating.
+  void reserve(size_t n) {
+    nodes_.reserve(n);
+    tags_.reserve(n);
+  }
+
+  // Removes all entries from the stack, retaining any allocated memory.
+  void clear() {
+    nodes_.clear();
+    pending_.clear();
+    tags_.clear();
   }
 
  private:
   template <int&..., typename Traverser, typename NodeType>
   friend void traverse_tree(preorder_traversal_tag, Traverser&,
-                            tree_traversal_stack<NodeType>);
+                            tree_traversal_stack<NodeType>&);
+  template <int&..., typename Traverser, typename NodeType>
+  friend void traverse_tree(postorder_traversal_tag, Traverser&,
+                            tree_traversal_stack<NodeType>&);
+  template <int&..., typename Traverser, typename NodeType>
+  friend void traverse_tree(breadth_first_traversal_tag, Traverser&,
+                            tree_traversal_stack<NodeType>&);
+
+  std::vector<value_type> nodes_;
+  // Nodes whose children are being visited in a post-order traversal, and which
+  // are to be visited themselves once they are done.
+  std::vector<value_type> pending_;
+  internal_algorithm::packed_tag_stack tags_;
+};
+
+namespace internal_algorithm {
 
-  std::vector<std::variant<internal_algorithm::enter_subtree_tag,
-                           internal_algorithm::enter_last_child_tag,
-                           internal_algorithm::exit_subtree_tag, value_type>>
-      stack_;
+template <typename Traverser>
+concept HasEnterSubtree = requires(Traverser& t) {
+  NthTraverseTreeEnterSubtree(t);
 };
 
+template <typename Traverser>
+concept HasExitSubtree = requires(Traverser& t) {
+  NthTraverseTreeExitSubtree(t);
+};
+
+template <typename Traverser>
+concept HasEnterLastChild = requires(Traverser& t) {
+  NthTraverseTreeEnterLastChild(t);
+};
+
+// Invokes the hook corresponding to an `enter_subtree` or `enter_last_child`
+// marker.
+template <typename Traverser>
+void InvokeEnterHook(Traverser& traverser, stack_tag tag) {
+  if (tag == stack_tag::enter_subtree) {
+    if constexpr (HasEnterSubtree<Traverser>) {
+      NthTraverseTreeEnterSubtree(traverser);
+    } else {
+      NTH_UNREACHABLE();
+    }
+  } else {
+    if constexpr (HasEnterLastChild<Traverser>) {
+      NthTraverseTreeEnterLastChild(traverser);
+    } else {
+      NTH_UNREACHABLE();
+    }
+  }
+}
+
+// Called after the children of a node have been pushed above the markers for
+// that node, with `first_child` the position of the tag for the first child
+// pushed. The `enter_last_child` marker, if any, is moved between the first
+// child pushed (which is visited last) and the remaining children, and an
+// `enter_subtree` marker, if needed, is pushed on top.
+template <typename Traverser>
+void MarkChildren(packed_tag_stack& tags, size_t first_child) {
+  if constexpr (HasEnterLastChild<Traverser>) {
+    tags.set(first_child - 1, stack_tag::node);
+    tags.set(first_child, stack_tag::enter_last_child);
+  }
+  if constexpr (HasEnterSubtree<Traverser>) {
+    tags.push(stack_tag::enter_subtree);
+  }
+}
+
+}  // namespace internal_algorithm
+
 template <int&..., typename Traverser, typename NodeType>
 void traverse_tree(preorder_traversal_tag, Traverser& traverser,
-                   tree_traversal_stack<NodeType> stack) {
-  static constexpr bool HasEnterSubtree = requires {
-    NthTraverseTreeEnterSubtree(traverser);
-  };
-  static constexpr bool HasExitSubtree = requires {
-    NthTraverseTreeExitSubtree(traverser);
-  };
-  static constexpr bool HasEnterLastChild = requires {
-    NthTraverseTreeEnterLastChild(traverser);
-  };
-
-  while (not stack.empty()) {
-    auto const& entry = stack.stack_.back();
-    switch (entry.index()) {
-      case 0:
-        if constexpr (HasEnterSubtree) {
-          stack.stack_.pop_back();
-          NthTraverseTreeEnterSubtree(traverser);
-          break;
-        } else {
-          NTH_UNREACHABLE();
-        }
-      case 1:
-        if constexpr (HasEnterLastChild) {
-          stack.stack_.pop_back();
-          NthTraverseTreeEnterLastChild(traverser);
-        } else {
-          NTH_UNREACHABLE();
-        }
+                   tree_traversal_stack<NodeType>& stack) {
+  using internal_algorithm::stack_tag;
+  static constexpr bool HasExitSubtree =
+      internal_algorithm::HasExitSubtree<Traverser>;
+  static constexpr bool HasEnterLastChild =
+      internal_algorithm::HasEnterLastChild<Traverser>;
+
+  auto& tags = stack.tags_;
+  while (not tags.empty()) {
+    switch (stack_tag tag = tags.back()) {
+      case stack_tag::enter_subtree:
+      case stack_tag::enter_last_child:
+        tags.pop();
+        internal_algorithm::InvokeEnterHook(traverser, tag);
         break;
-      case 2:
+      case stack_tag::exit_subtree:
         if constexpr (HasExitSubtree) {
-          stack.stack_.pop_back();
+          tags.pop();
           NthTraverseTreeExitSubtree(traverser);
-          break;
         } else {
           NTH_UNREACHABLE();
         }
-      default: {
-        NodeType node = NTH_MOVE(std::get<3>(stack.stack_.back()));
-        if constexpr (HasExitSubtree) {
-          stack.stack_.back() = internal_algorithm::exit_subtree_tag{};
-          if constexpr (HasEnterLastChild) {
-            stack.stack_.push_back(internal_algorithm::enter_last_child_tag{});
-          }
-        } else if constexpr (HasEnterLastChild) {
-          stack.stack_.back() = internal_algorithm::enter_last_child_tag{};
-        } else {
-          stack.stack_.pop_back();
+        break;
+      case stack_tag::node: {
+        NodeType node = NTH_MOVE(stack.nodes_.back());
+        stack.nodes_.pop_back();
+        tags.pop();
+        if constexpr (HasExitSubtree) { tags.push(stack_tag::exit_subtree); }
+        if constexpr (HasEnterLastChild) {
+          tags.push(stack_tag::enter_last_child);
         }
 
-        size_t previous_size = stack.stack_.size();
+        size_t previous_size = tags.size();
         NthTraverseTreeNode(traverser, node, stack);
-        size_t child_count = stack.stack_.size() - previous_size;
-        if (child_count == 0) {
-          stack.stack_.resize(stack.stack_.size() -
-                              (HasExitSubtree + HasEnterLastChild));
+        if (tags.size() == previous_size) {
+          tags.pop(HasExitSubtree + HasEnterLastChild);
         } else {
-          if constexpr (HasEnterLastChild) {
-            std::span prefixed_children(&stack.stack_.back() - child_count,
-                                        child_count + 1);
-            auto temp            = NTH_MOVE(prefixed_children[0]);
-            prefixed_children[0] = NTH_MOVE(prefixed_children[1]);
-            prefixed_children[1] = NTH_MOVE(temp);
-          }
-          if constexpr (HasEnterSubtree) {
-            stack.stack_.push_back(internal_algorithm::enter_subtree_tag{});
-          }
+          internal_algorithm::MarkChildren<Traverser>(tags, previous_size);
         }
       } break;
     }
   }
 }
 
+template <int&..., typename Traverser, typename NodeType>
+void traverse_tree(postorder_traversal_tag, Traverser& traverser,
+                   tree_traversal_stack<NodeType>& stack) {
+  using internal_algorithm::stack_tag;
+  static constexpr bool HasExitSubtree =
+      internal_algorithm::HasExitSubtree<Traverser>;
+  static constexpr bool HasEnterLastChild =
+      internal_algorithm::HasEnterLastChild<Traverser>;
+
+  // Every node whose children are being visited has an `exit_subtree` marker
+  // beneath its children, regardless of whether the traverser has an
+  // `NthTraverseTreeExitSubtree` hook. Popping the marker visits the node,
+  // which is at the back of `stack.pending_`.
+  auto& tags = stack.tags_;
+  while (not tags.empty()) {
+    switch (stack_tag tag = tags.back()) {
+      case stack_tag::enter_subtree:
+      case stack_tag::enter_last_child:
+        tags.pop();
+        internal_algorithm::InvokeEnterHook(traverser, tag);
+        break;
+      case stack_tag::exit_subtree:
+        tags.pop();
+        if constexpr (HasExitSubtree) { NthTraverseTreeExitSubtree(traverser); }
+        NthTraverseTreeNode(traverser, stack.pending_.back());
+        stack.pending_.pop_back();
+        break;
+      case stack_tag::node: {
+        // `pending_` is not modified while children are pushed, so references
+        // into it remain valid.
+        stack.pending_.push_back(NTH_MOVE(stack.nodes_.back()));
+        stack.nodes_.pop_back();
+        tags.set(tags.size() - 1, stack_tag::exit_subtree);
+        if constexpr (HasEnterLastChild) {
+          tags.push(stack_tag::enter_last_child);
+        }
+
+        size_t previous_size = tags.size();
+        NthTraverseTreeChildren(traverser, stack.pending_.back(), stack);
+        if (tags.size() == previous_size) {
+          tags.pop(1 + HasEnterLastChild);
+          NthTraverseTreeNode(traverser, stack.pending_.back());
+          stack.pending_.pop_back();
+        } else {
+          internal_algorithm::MarkChildren<Traverser>(tags, previous_size);
+        }
+      } break;
+    }
+  }
+}
+
+template <int&..., typename Traverser, typename NodeType>
+void traverse_tree(breadth_first_traversal_tag, Traverser& traverser,
+                   tree_traversal_stack<NodeType>& stack) {
+  // The vector of nodes is used as a queue, with the nodes in
+  // `[head, stack.nodes_.size())` yet to be visited. Each batch of pushed nodes
+  // is reversed, so that nodes pushed last are visited first, just as in a
+  // depth-first traversal. Only nodes are ever pushed, so the only tags are
+  // those for nodes, one for each node yet to be visited.
+  auto& nodes = stack.nodes_;
+  std::reverse(nodes.begin(), nodes.end());
+  size_t head = 0;
+  while (head != nodes.size()) {
+    NodeType node = NTH_MOVE(nodes[head++]);
+    stack.tags_.pop();
+    size_t previous_size = nodes.size();
+    NthTraverseTreeNode(traverser, node, stack);
+    std::reverse(nodes.begin() + previous_size, nodes.end());
+
+    // Discard visited nodes once they make up at least half of the queue, so
+    // that the memory used is proportional to the widest level of the tree
+    // rather than to the size of the whole tree.
+    if (head >= 64 and 2 * head >= nodes.size()) {
+      nodes.erase(nodes.begin(), nodes.begin() + head);
+      head = 0;
+    }
+  }
+  nodes.clear();
+}
+
+template <int&..., typename Tag, typename Traverser, typename NodeType>
+void traverse_tree(Tag tag, Traverser& traverser,
+                   tree_traversal_stack<NodeType>&& stack) {
+  traverse_tree(tag, traverser, stack);
+}
+
 }  // namespace nth
 
 #endif  // NTH_ALGORITHM_TREE_H
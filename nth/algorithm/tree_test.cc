@@ -23,11 +23,18 @@ struct Traverser {
   friend void NthTraverseTreeNode(Traverser& t, int n,
                                   nth::tree_traversal_stack<int>& stack) {
     t.nodes.push_back(n);
+    NthTraverseTreeChildren(t, n, stack);
+  }
+
+  friend void NthTraverseTreeChildren(Traverser& t, int n,
+                                      nth::tree_traversal_stack<int>& stack) {
     for (size_t i = 0; i < t.tree.indices.size(); ++i) {
       if (t.tree.indices[i] == n) { stack.push(i); }
     }
   }
 
+  friend void NthTraverseTreeNode(Traverser& t, int n) { t.nodes.push_back(n); }
+
   friend void NthTraverseTreeEnterSubtree(Traverser& t) requires(
       HasEnterSubtree) {
     t.nodes.push_back(enter_subtree);
@@ -181,6 +188,132 @@ void TraverseComplexPreorderHasEnterLastChild() {
                                                   exit_subtree});
 }
 
+void TraverseComplexPostorder() {
+  Tree tree = {.indices = {-1, 0, 1, 2, 0, 1, 2, 4, 7, 7, 7, 7}};
+  Traverser<false, false, false> t{.tree = tree};
+  nth::tree_traversal_stack<int> stack;
+  stack.push(0);
+  nth::traverse_tree(nth::postorder, t, stack);
+  NTH_RAW_TEST_ASSERT(t.nodes ==
+                      std::vector<int>{11, 10, 9, 8, 7, 4, 5, 6, 3, 2, 1, 0});
+}
+
+void TraverseMultiplePostorder() {
+  Tree tree = {.indices = {-1, 0, 1, 2}};
+  Traverser<false, false, false> t{.tree = tree};
+  nth::tree_traversal_stack<int> stack;
+  stack.push(1);
+  stack.push(0);
+  nth::traverse_tree(nth::postorder, t, stack);
+  NTH_RAW_TEST_ASSERT(t.nodes == std::vector<int>{3, 2, 1, 0, 3, 2, 1});
+}
+
+void TraverseComplexPostorderHasEnterLastChild() {
+  Tree tree = {.indices = {-1, 0, 1, 2, 0, 1, 2, 4, 7, 7, 7, 7}};
+  Traverser<true, true, true> t{.tree = tree};
+  nth::tree_traversal_stack<int> stack;
+  stack.push(0);
+  nth::traverse_tree(nth::postorder, t, stack);
+
+  NTH_RAW_TEST_ASSERT(t.nodes == std::vector<int>{enter_subtree,
+                                                  enter_subtree,
+                                                  enter_last_child,
+                                                  enter_subtree,
+                                                  11,
+                                                  10,
+                                                  9,
+                                                  enter_last_child,
+                                                  8,
+                                                  exit_subtree,
+                                                  7,
+                                                  exit_subtree,
+                                                  4,
+                                                  enter_last_child,
+                                                  enter_subtree,
+                                                  5,
+                                                  enter_last_child,
+                                                  enter_subtree,
+                                                  6,
+                                                  enter_last_child,
+                                                  3,
+                                                  exit_subtree,
+                                                  2,
+                                                  exit_subtree,
+                                                  1,
+                                                  exit_subtree,
+                                                  0});
+}
+
+void TraverseComplexBreadthFirst() {
+  Tree tree = {.indices = {-1, 0, 1, 2, 0, 1, 2, 4, 7, 7, 7, 7}};
+  Traverser<true, true, true> t{.tree = tree};
+  nth::tree_traversal_stack<int> stack;
+  stack.push(0);
+  nth::traverse_tree(nth::breadth_first, t, stack);
+  NTH_RAW_TEST_ASSERT(t.nodes ==
+                      std::vector<int>{0, 4, 1, 7, 5, 2, 11, 10, 9, 8, 6, 3});
+}
+
+// A tree whose root has enough children that the tags describing the stack
+// span several words.
+void TraverseWide() {
+  Tree tree;
+  tree.indices.push_back(-1);
+  for (int i = 1; i <= 100; ++i) { tree.indices.push_back(0); }
+
+  std::vector<int> preorder  = {0, enter_subtree};
+  std::vector<int> postorder = {enter_subtree};
+  for (int i = 100; i > 1; --i) {
+    preorder.push_back(i);
+    postorder.push_back(i);
+  }
+  for (int i : {enter_last_child, 1, exit_subtree}) {
+    preorder.push_back(i);
+    postorder.push_back(i);
+  }
+  postorder.push_back(0);
+
+  Traverser<true, true, true> pre{.tree = tree};
+  nth::tree_traversal_stack<int> stack;
+  stack.push(0);
+  nth::traverse_tree(nth::preorder, pre, stack);
+  NTH_RAW_TEST_ASSERT(pre.nodes == preorder);
+
+  Traverser<true, true, true> post{.tree = tree};
+  stack.push(0);
+  nth::traverse_tree(nth::postorder, post, stack);
+  NTH_RAW_TEST_ASSERT(post.nodes == postorder);
+
+  std::vector<int> breadth_first = {0};
+  for (int i = 100; i > 0; --i) { breadth_first.push_back(i); }
+  Traverser<true, true, true> breadth{.tree = tree};
+  stack.push(0);
+  nth::traverse_tree(nth::breadth_first, breadth, stack);
+  NTH_RAW_TEST_ASSERT(breadth.nodes == breadth_first);
+}
+
+void ReuseStack() {
+  Tree tree = {.indices = {-1, 0, 1, 2, 0, 1, 2, 4, 7, 7, 7, 7}};
+  nth::tree_traversal_stack<int> stack;
+  stack.reserve(16);
+  for (int n = 0; n < 3; ++n) {
+    Traverser<true, true, true> t{.tree = tree};
+    stack.push(0);
+    nth::traverse_tree(nth::preorder, t, stack);
+    NTH_RAW_TEST_ASSERT(stack.empty());
+    NTH_RAW_TEST_ASSERT(t.nodes.size() == 27);
+  }
+
+  stack.push(3);
+  stack.push(4);
+  stack.clear();
+  NTH_RAW_TEST_ASSERT(stack.empty());
+  Traverser<false, false, false> t{.tree = tree};
+  stack.push(2);
+  nth::traverse_tree(nth::breadth_first, t, stack);
+  NTH_RAW_TEST_ASSERT(t.nodes == std::vector<int>{2, 6, 3});
+}
+
 }  // namespace
 
 int main() {
@@ -192,4 +325,10 @@ int main() {
   TraverseComplexPreorderHasExitSubtree();
   TraverseComplexPreorderHasEnterAndExitSubtree();
   TraverseComplexPreorderHasEnterLastChild();
+  TraverseComplexPostorder();
+  TraverseMultiplePostorder();
+  TraverseComplexPostorderHasEnterLastChild();
+  TraverseComplexBreadthFirst();
+  TraverseWide();
+  ReuseStack();
 }
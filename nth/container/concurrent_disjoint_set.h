@@ -0,0 +1,190 @@
+#ifndef NTH_CONTAINER_CONCURRENT_DISJOINT_SET_H
+#define NTH_CONTAINER_CONCURRENT_DISJOINT_SET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nth/debug/debug.h"
+
+namespace nth {
+
+// A `concurrent_disjoint_set` is a thread-safe `dense_disjoint_set` over the
+// integers in `[0, size())`, whose size is fixed at construction. Any number of
+// threads may concurrently call `representative`, `join` and `same_subset`
+// without taking a lock.
+//
+// Each element stores the index of its parent in a single atomic. Subsets are
+// linked by index: the root with the greater index is pointed at the root with
+// the lesser index with a compare-and-swap, which fails and is retried if
+// another thread linked either root first. Because a parent never has a
+// greater index than its child, no interleaving of operations can form a
+// cycle, and the representative of each subset is its least element.
+// Representatives are found with path halving, whose updates only ever move an
+// element's parent closer to the root and so are correct even if they race
+// with one another or with linking.
+struct concurrent_disjoint_set {
+  using value_type = uint32_t;
+
+  // Constructs a `concurrent_disjoint_set` containing the elements in
+  // `[0, count)`, each in a separate subset.
+  explicit concurrent_disjoint_set(size_t count);
+
+  concurrent_disjoint_set(concurrent_disjoint_set const&)            = delete;
+  concurrent_disjoint_set& operator=(concurrent_disjoint_set const&) = delete;
+
+  // Returns the representative of the subset containing `v`, which is the
+  // least element of that subset at some point during the call. Behavior is
+  // undefined if `v` is not an element of the set.
+  value_type representative(value_type v);
+
+  // After invocation, `a` and `b` will be contained in the same subset. Returns
+  // the representative of the newly formed subset at the time of linking.
+  value_type join(value_type a, value_type b);
+
+  // Returns whether `a` and `b` are contained in the same subset. Subsets are
+  // only ever joined, so a result of `true` remains true.
+  bool same_subset(value_type a, value_type b);
+
+  // Returns the number of disjoint subsets. Must not be called concurrently
+  // with `join`.
+  size_t subset_count() const;
+
+  // Returns the number of elements in the set (not the number of subsets).
+  size_t size() const { return size_; }
+
+  // Returns whether or not the set is empty.
+  bool empty() const { return size_ == 0; }
+
+ private:
+  std::unique_ptr<std::atomic<value_type>[]> parents_;
+  size_t size_;
+};
+
+// Computes the connected components of the graph on vertices
+// `[0, vertex_count)` with the given `edges`, which are partitioned among
+// `thread_count` threads. Returns a vector holding, for each vertex, the least
+// vertex in its component.
+std::vector<uint32_t> ConnectedComponents(
+    size_t vertex_count, std::span<std::pair<uint32_t, uint32_t> const> edges,
+    size_t thread_count = 1);
+
+// Implementation
+
+namespace internal_concurrent_disjoint_set {
+
+// Invokes `f(begin, end)` on `thread_count` threads, with `[begin, end)`
+// partitioning `[0, count)` into contiguous ranges of nearly equal size.
+template <typename F>
+void ParallelFor(size_t count, size_t thread_count, F f) {
+  thread_count = std::max<size_t>(1, std::min(thread_count, count));
+  if (thread_count == 1) {
+    f(size_t{0}, count);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back(f, count * t / thread_count,
+                         count * (t + 1) / thread_count);
+  }
+  for (auto& thread : threads) { thread.join(); }
+}
+
+}  // namespace internal_concurrent_disjoint_set
+
+inline concurrent_disjoint_set::concurrent_disjoint_set(size_t count)
+    : parents_(std::make_unique<std::atomic<value_type>[]>(count)),
+      size_(count) {
+  NTH_REQUIRE((harden), count <= std::numeric_limits<value_type>::max());
+  for (size_t i = 0; i < count; ++i) {
+    parents_[i].store(static_cast<value_type>(i), std::memory_order_relaxed);
+  }
+}
+
+inline concurrent_disjoint_set::value_type
+concurrent_disjoint_set::representative(value_type v) {
+  NTH_REQUIRE((debug), v < size());
+  while (true) {
+    value_type parent = parents_[v].load(std::memory_order_acquire);
+    if (parent == v) { return v; }
+    value_type grandparent = parents_[parent].load(std::memory_order_acquire);
+    if (grandparent != parent) {
+      // A failure means another thread has already moved `v` closer to the
+      // root, which is just as good.
+      parents_[v].compare_exchange_weak(parent, grandparent,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_relaxed);
+    }
+    v = grandparent;
+  }
+}
+
+inline concurrent_disjoint_set::value_type concurrent_disjoint_set::join(
+    value_type a, value_type b) {
+  while (true) {
+    a = representative(a);
+    b = representative(b);
+    if (a == b) { return a; }
+    if (a < b) { std::swap(a, b); }
+    // `a` is only linked if it is still a root; otherwise some other thread has
+    // linked it, and we retry from its new representative.
+    value_type expected = a;
+    if (parents_[a].compare_exchange_strong(expected, b,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+      return b;
+    }
+  }
+}
+
+inline bool concurrent_disjoint_set::same_subset(value_type a, value_type b) {
+  while (true) {
+    a = representative(a);
+    b = representative(b);
+    if (a == b) { return true; }
+    // If `a` is still a root, then `a` and `b` were in different subsets at the
+    // moment `b` was found to be a root. Otherwise, `a` was linked in the
+    // meantime and we must look again.
+    if (parents_[a].load(std::memory_order_acquire) == a) { return false; }
+  }
+}
+
+inline size_t concurrent_disjoint_set::subset_count() const {
+  size_t count = 0;
+  for (size_t i = 0; i < size_; ++i) {
+    if (parents_[i].load(std::memory_order_relaxed) == i) { ++count; }
+  }
+  return count;
+}
+
+inline std::vector<uint32_t> ConnectedComponents(
+    size_t vertex_count, std::span<std::pair<uint32_t, uint32_t> const> edges,
+    size_t thread_count) {
+  concurrent_disjoint_set set(vertex_count);
+  internal_concurrent_disjoint_set::ParallelFor(
+      edges.size(), thread_count, [&](size_t begin, size_t end) {
+        for (auto [a, b] : edges.subspan(begin, end - begin)) {
+          set.join(a, b);
+        }
+      });
+  std::vector<uint32_t> components(vertex_count);
+  internal_concurrent_disjoint_set::ParallelFor(
+      vertex_count, thread_count, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+          components[v] = set.representative(static_cast<uint32_t>(v));
+        }
+      });
+  return components;
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_CONCURRENT_DISJOINT_SET_H
@@ -0,0 +1,143 @@
+#include "nth/container/concurrent_disjoint_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nth/container/dense_disjoint_set.h"
+#include "nth/container/disjoint_set.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+std::vector<std::pair<uint32_t, uint32_t>> RandomEdges(uint32_t vertex_count,
+                                                       size_t edge_count) {
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  edges.reserve(edge_count);
+  uint64_t state = 1;
+  auto next      = [&] {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    return static_cast<uint32_t>((state >> 32) % vertex_count);
+  };
+  for (size_t i = 0; i < edge_count; ++i) {
+    uint32_t a = next();
+    edges.emplace_back(a, next());
+  }
+  return edges;
+}
+
+NTH_TEST("concurrent_disjoint_set/empty") {
+  concurrent_disjoint_set set(0);
+  NTH_EXPECT(set.empty());
+  NTH_EXPECT(set.size() == 0u);
+  NTH_EXPECT(set.subset_count() == 0u);
+}
+
+NTH_TEST("concurrent_disjoint_set/join") {
+  concurrent_disjoint_set set(4);
+  NTH_EXPECT(set.size() == 4u);
+  NTH_EXPECT(set.subset_count() == 4u);
+  for (uint32_t i = 0; i < 4; ++i) { NTH_EXPECT(set.representative(i) == i); }
+
+  NTH_EXPECT(set.join(3, 2) == 2u);
+  NTH_EXPECT(set.same_subset(2, 3));
+  NTH_EXPECT(not set.same_subset(1, 3));
+  NTH_EXPECT(set.subset_count() == 3u);
+
+  NTH_EXPECT(set.join(3, 1) == 1u);
+  NTH_EXPECT(set.join(2, 1) == 1u);
+  NTH_EXPECT(set.representative(3) == 1u);
+  NTH_EXPECT(not set.same_subset(0, 3));
+  NTH_EXPECT(set.subset_count() == 2u);
+}
+
+NTH_TEST("concurrent_disjoint_set/concurrent-join", size_t thread_count) {
+  constexpr uint32_t VertexCount = 1 << 12;
+  auto edges = RandomEdges(VertexCount, VertexCount / 2);
+
+  dense_disjoint_set expected(VertexCount);
+  expected.join(edges);
+
+  concurrent_disjoint_set set(VertexCount);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&, t] {
+      // Every thread joins every edge, in a different order, so that links
+      // race with one another.
+      for (size_t i = 0; i < edges.size(); ++i) {
+        auto [a, b] = edges[(i * (2 * t + 1)) % edges.size()];
+        set.join(a, b);
+        NTH_ASSERT(set.same_subset(a, b));
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  NTH_EXPECT(set.subset_count() == expected.subset_count());
+  for (auto [a, b] : RandomEdges(VertexCount, VertexCount)) {
+    NTH_ASSERT(set.same_subset(a, b) == expected.same_subset(a, b));
+  }
+}
+
+NTH_INVOKE_TEST("concurrent_disjoint_set/concurrent-join") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+NTH_TEST("concurrent_disjoint_set/connected-components", size_t thread_count) {
+  constexpr uint32_t VertexCount = 1 << 12;
+  auto edges = RandomEdges(VertexCount, VertexCount / 2);
+  std::vector<uint32_t> components =
+      ConnectedComponents(VertexCount, edges, thread_count);
+  NTH_ASSERT(components.size() == VertexCount);
+
+  dense_disjoint_set expected(VertexCount);
+  expected.join(edges);
+  for (uint32_t v = 0; v < VertexCount; ++v) {
+    NTH_ASSERT(components[v] <= v);
+    NTH_ASSERT(components[components[v]] == components[v]);
+    NTH_ASSERT(expected.same_subset(v, components[v]));
+  }
+  for (auto [a, b] : RandomEdges(VertexCount, VertexCount)) {
+    NTH_ASSERT((components[a] == components[b]) == expected.same_subset(a, b));
+  }
+}
+
+NTH_INVOKE_TEST("concurrent_disjoint_set/connected-components") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+NTH_TEST("concurrent_disjoint_set/benchmark/connected-components",
+         size_t thread_count) {
+  constexpr uint32_t VertexCount = 1 << 20;
+  auto edges = RandomEdges(VertexCount, VertexCount);
+  NTH_MEASURE() {
+    NTH_TIME("concurrent") {
+      auto components = ConnectedComponents(VertexCount, edges, thread_count);
+      nth::DoNotOptimize(components);
+    }
+    NTH_TIME("dense_disjoint_set") {
+      dense_disjoint_set set(VertexCount);
+      set.join(edges);
+      size_t count = set.subset_count();
+      nth::DoNotOptimize(count);
+    }
+    NTH_TIME("disjoint_set") {
+      disjoint_set<uint32_t> set;
+      for (uint32_t v = 0; v < VertexCount; ++v) { set.insert(v); }
+      for (auto [a, b] : edges) { set.join(set.find(a), set.find(b)); }
+      size_t size = set.size();
+      nth::DoNotOptimize(size);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("concurrent_disjoint_set/benchmark/connected-components") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+}  // namespace
+}  // namespace nth
@@ -0,0 +1,276 @@
+#ifndef NTH_CONTAINER_CONCURRENT_FLYWEIGHT_SET_H
+#define NTH_CONTAINER_CONCURRENT_FLYWEIGHT_SET_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "nth/container/internal/chunked_vector.h"
+#include "nth/container/internal/index.h"
+#include "nth/debug/debug.h"
+#include "nth/meta/concepts/hash.h"
+
+namespace nth {
+namespace internal_concurrent_flyweight_set {
+
+// Maps dense indices to pointers. Slots are allocated in segments, each twice
+// the size of the one before it, so that existing slots never move and may be
+// read without synchronizing with concurrent appends.
+template <typename T>
+struct directory {
+  directory() = default;
+  directory(directory const&)            = delete;
+  directory& operator=(directory const&) = delete;
+
+  ~directory() {
+    for (auto& segment : segments_) {
+      delete[] segment.load(std::memory_order_relaxed);
+    }
+  }
+
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  // Reserves the next index, and stores `p` in its slot.
+  size_t push(T const* p) {
+    size_t n               = size_.fetch_add(1, std::memory_order_relaxed);
+    auto [segment, offset] = locate(n);
+    T const** slots = segments_[segment].load(std::memory_order_acquire);
+    if (slots == nullptr) { slots = allocate(segment); }
+    slots[offset] = p;
+    return n;
+  }
+
+  // Returns the pointer stored at index `n`. The caller must have synchronized
+  // with the call to `push` which returned `n`.
+  T const* operator[](size_t n) const {
+    auto [segment, offset] = locate(n);
+    return segments_[segment].load(std::memory_order_acquire)[offset];
+  }
+
+ private:
+  static constexpr size_t FirstSegmentSizeLog2 = 10;
+
+  // Segment 0 holds indices in [0, 2^B), and segment `k > 0` holds indices in
+  // [2^(B+k-1), 2^(B+k)), where `B` is `FirstSegmentSizeLog2`.
+  static std::pair<size_t, size_t> locate(size_t n) {
+    if (n < (size_t{1} << FirstSegmentSizeLog2)) { return {0, n}; }
+    size_t width = std::bit_width(n);
+    return {width - FirstSegmentSizeLog2, n - (size_t{1} << (width - 1))};
+  }
+
+  static size_t segment_size(size_t segment) {
+    return size_t{1} << (segment == 0 ? FirstSegmentSizeLog2
+                                      : FirstSegmentSizeLog2 + segment - 1);
+  }
+
+  T const** allocate(size_t segment) {
+    T const** slots    = new T const*[segment_size(segment)]();
+    T const** expected = nullptr;
+    if (segments_[segment].compare_exchange_strong(expected, slots,
+                                                   std::memory_order_acq_rel)) {
+      return slots;
+    }
+    delete[] slots;
+    return expected;
+  }
+
+  std::atomic<size_t> size_ = 0;
+  std::array<std::atomic<T const**>,
+             std::numeric_limits<size_t>::digits - FirstSegmentSizeLog2 + 1>
+      segments_ = {};
+};
+
+}  // namespace internal_concurrent_flyweight_set
+
+// `concurrent_flyweight_set<V>` is a thread-safe container of distinct values,
+// each of which is assigned a dense index in the order in which it was
+// inserted. As with `flyweight_set`, pointers to elements are never
+// invalidated for the lifetime of the container.
+//
+// Elements are partitioned by hash into `Shards` independently locked shards,
+// so that threads interning different values rarely contend with one another.
+// Within a shard, lookups of elements already present take a shared lock, and
+// only insertions take an exclusive lock. Each element's hash is computed once
+// and cached. Converting an index to its element with `from_index` takes no
+// lock at all.
+template <typename V, nth::hasher<V> Hash = absl::Hash<V>,
+          std::equivalence_relation<V, V> Eq = std::equal_to<V>,
+          size_t Shards = 16>
+requires(std::has_single_bit(Shards))  //
+struct concurrent_flyweight_set {
+  using value_type = V;
+  using size_type  = size_t;
+  using hasher     = Hash;
+  using key_equal  = Eq;
+
+  concurrent_flyweight_set() {
+    for (shard& s : shards_) { s.set = shard_set(0, H{}, E(&directory_)); }
+  }
+
+  concurrent_flyweight_set(concurrent_flyweight_set const&) = delete;
+  concurrent_flyweight_set& operator=(concurrent_flyweight_set const&) =
+      delete;
+
+  // Returns the number of elements in the container. While other threads are
+  // inserting, this may include elements whose insertion has not yet
+  // completed.
+  size_type size() const { return directory_.size(); }
+  bool empty() const { return size() == 0; }
+
+  // Attempts to insert an element into the container of value `v`. If an
+  // equivalent element already exists, no item is inserted. A pair is returned
+  // where the first element is the index of the element in the container
+  // equivalent to `v`, and the second indicates whether an insertion actually
+  // took place.
+  std::pair<size_t, bool> insert(value_type const& v) { return insert_impl(v); }
+
+  // Attempts to insert an element into the container of value `v`. If an
+  // equivalent element already exists, no item is inserted and the object
+  // referenced by `v` is unmodified. Otherwise, the object referenced by `v` is
+  // left in its moved-from state. Returns the same as the overload above.
+  std::pair<size_t, bool> insert(value_type&& v) {
+    return insert_impl(std::move(v));
+  }
+
+  // Returns a pointer to an element in the container equivalent to `v` if one
+  // exists, or a null pointer otherwise.
+  value_type const* find(value_type const& v) const {
+    size_t n = index(v);
+    return n == end_index() ? nullptr : directory_[n];
+  }
+
+  // Returns the index of an element equivalent to `v` if it is in the
+  // container. If not present, returns `end_index()`.
+  size_t index(value_type const& v) const {
+    internal_container::HashedKey<value_type> key = hashed_key(v);
+    shard const& s = shard_for(key.hash);
+    absl::ReaderMutexLock lock(&s.mutex);
+    auto iter = s.set.find(key);
+    return iter == s.set.end() ? end_index() : iter->value;
+  }
+
+  // Returns a reference to the element indexed by `n`. Behavior is undefined
+  // unless `n` was returned by `insert` or `index`, on this or another thread
+  // which has since synchronized with this one.
+  value_type const& from_index(size_t n) const {
+    NTH_REQUIRE((harden), n < size());
+    return *directory_[n];
+  }
+
+  // Returns a value for which `index(v) == end_index()` is false for every `v`
+  // in the container.
+  size_t end_index() const { return std::numeric_limits<size_t>::max(); }
+
+ private:
+  struct H {
+    using is_transparent = void;
+
+    size_t operator()(internal_container::HashedIndex p) const {
+      return p.hash;
+    }
+    size_t operator()(
+        internal_container::HashedKey<value_type> const& k) const {
+      return k.hash;
+    }
+  };
+
+  struct E : private key_equal {
+    explicit E(
+        internal_concurrent_flyweight_set::directory<value_type> const* d)
+        : directory_(d) {}
+
+    using is_transparent = void;
+
+    bool operator()(internal_container::HashedIndex lhs,
+                    internal_container::HashedIndex rhs) const {
+      return lhs.value == rhs.value;
+    }
+
+    bool operator()(
+        internal_container::HashedIndex lhs,
+        internal_container::HashedKey<value_type> const& rhs) const {
+      return lhs.hash == rhs.hash and
+             key_equal::operator()(*(*directory_)[lhs.value], rhs.value);
+    }
+
+    bool operator()(internal_container::HashedKey<value_type> const& lhs,
+                    internal_container::HashedIndex rhs) const {
+      return operator()(rhs, lhs);
+    }
+
+   private:
+    internal_concurrent_flyweight_set::directory<value_type> const* directory_;
+  };
+
+  using shard_set = absl::flat_hash_set<internal_container::HashedIndex, H, E>;
+
+  // Shards are aligned to separate cache lines so that threads locking
+  // different shards do not contend on the same line.
+  struct alignas(64) shard {
+    mutable absl::Mutex mutex;
+    internal_container::chunked_vector<value_type> values;
+    shard_set set{0, H{}, E(nullptr)};
+  };
+
+  // The shard is chosen from the high bits of the hash after multiplying by a
+  // constant, which spreads hashers of poor quality (e.g., the identity) across
+  // shards and keeps the choice independent of the low bits used by the
+  // shard's own table.
+  shard& shard_for(size_t hash) { return shards_[shard_index(hash)]; }
+  shard const& shard_for(size_t hash) const {
+    return shards_[shard_index(hash)];
+  }
+  static size_t shard_index(size_t hash) {
+    if constexpr (Shards == 1) {
+      return 0;
+    } else {
+      constexpr int Shift =
+          std::numeric_limits<size_t>::digits - std::countr_zero(Shards);
+      return (static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15) >> Shift;
+    }
+  }
+
+  internal_container::HashedKey<value_type> hashed_key(
+      value_type const& v) const {
+    return {.value = v, .hash = static_cast<size_t>(hash_(v))};
+  }
+
+  template <typename T>
+  std::pair<size_t, bool> insert_impl(T&& v) {
+    internal_container::HashedKey<value_type> key = hashed_key(v);
+    shard& s = shard_for(key.hash);
+    {
+      absl::ReaderMutexLock lock(&s.mutex);
+      if (auto iter = s.set.find(key); iter != s.set.end()) {
+        return std::pair<size_t, bool>(iter->value, false);
+      }
+    }
+
+    absl::MutexLock lock(&s.mutex);
+    // Another thread may have inserted an equivalent element between releasing
+    // the shared lock and acquiring the exclusive one.
+    if (auto iter = s.set.find(key); iter != s.set.end()) {
+      return std::pair<size_t, bool>(iter->value, false);
+    }
+    size_t hash = key.hash;
+    size_t n    = directory_.push(&s.values.emplace_back(std::forward<T>(v)));
+    s.set.insert({.value = n, .hash = hash});
+    return std::pair<size_t, bool>(n, true);
+  }
+
+  [[no_unique_address]] hasher hash_;
+  internal_concurrent_flyweight_set::directory<value_type> directory_;
+  std::array<shard, Shards> shards_;
+};
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_CONCURRENT_FLYWEIGHT_SET_H
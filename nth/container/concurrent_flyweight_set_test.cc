@@ -0,0 +1,135 @@
+#include "nth/container/concurrent_flyweight_set.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nth/container/flyweight_set.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("concurrent_flyweight_set/default-construction") {
+  concurrent_flyweight_set<std::string> f;
+  NTH_EXPECT(f.empty());
+  NTH_EXPECT(f.size() == size_t{0});
+  NTH_EXPECT(f.find("a") == nullptr);
+  NTH_EXPECT(f.index("a") == f.end_index());
+}
+
+NTH_TEST("concurrent_flyweight_set/insert") {
+  concurrent_flyweight_set<std::string> f;
+  auto [a, a_inserted] = f.insert("a");
+  NTH_EXPECT(a == size_t{0});
+  NTH_EXPECT(a_inserted);
+  auto [b, b_inserted] = f.insert("b");
+  NTH_EXPECT(b == size_t{1});
+  NTH_EXPECT(b_inserted);
+  auto [a2, a2_inserted] = f.insert("a");
+  NTH_EXPECT(a2 == size_t{0});
+  NTH_EXPECT(not a2_inserted);
+  NTH_EXPECT(f.size() == size_t{2});
+
+  std::string s = "c";
+  NTH_EXPECT(f.insert(std::move(s)).second);
+  s = "c";
+  NTH_EXPECT(not f.insert(std::move(s)).second);
+  NTH_EXPECT(s == "c");
+
+  NTH_EXPECT(f.index("b") == size_t{1});
+  NTH_EXPECT(f.from_index(2) == "c");
+  NTH_ASSERT(f.find("a") != nullptr);
+  NTH_EXPECT(*f.find("a") == "a");
+}
+
+NTH_TEST("concurrent_flyweight_set/pointer-stability") {
+  concurrent_flyweight_set<size_t, absl::Hash<size_t>, std::equal_to<size_t>,
+                           4>
+      f;
+  std::vector<size_t const*> pointers;
+  for (size_t i = 0; i < 10000; ++i) {
+    pointers.push_back(&f.from_index(f.insert(i).first));
+  }
+  for (size_t i = 0; i < 10000; ++i) {
+    NTH_ASSERT(f.find(i) == pointers[i]);
+    NTH_ASSERT(f.index(i) == i);
+  }
+}
+
+NTH_TEST("concurrent_flyweight_set/threads") {
+  constexpr size_t ThreadCount = 8;
+  constexpr size_t ValueCount  = 2000;
+  concurrent_flyweight_set<std::string> f;
+  std::vector<std::vector<size_t>> indices(ThreadCount);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < ThreadCount; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < ValueCount; ++i) {
+        // Each thread interns the values in a different order.
+        size_t n = (i * (2 * t + 1)) % ValueCount;
+        indices[t].push_back(f.insert(std::to_string(n)).first);
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  NTH_ASSERT(f.size() == ValueCount);
+  for (size_t t = 0; t < ThreadCount; ++t) {
+    for (size_t i = 0; i < ValueCount; ++i) {
+      size_t n = (i * (2 * t + 1)) % ValueCount;
+      NTH_ASSERT(f.from_index(indices[t][i]) == std::to_string(n));
+    }
+  }
+}
+
+// Has each of `thread_count` threads intern the same identifiers, either
+// into a `concurrent_flyweight_set` or into a `flyweight_set` guarded by a
+// single mutex.
+template <typename Set>
+void intern(Set& set, std::vector<std::string> const& identifiers,
+            size_t thread_count) {
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&] {
+      for (auto const& identifier : identifiers) {
+        auto result = set.insert(identifier);
+        nth::DoNotOptimize(result);
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+}
+
+struct locked_flyweight_set {
+  auto insert(std::string const& s) {
+    std::lock_guard lock(mutex);
+    return set.insert(s);
+  }
+
+  std::mutex mutex;
+  flyweight_set<std::string> set;
+};
+
+NTH_TEST("concurrent_flyweight_set/benchmark/intern", size_t thread_count) {
+  std::vector<std::string> identifiers;
+  for (int i = 0; i < 4096; ++i) {
+    identifiers.push_back("identifier_" + std::to_string(i % 1024));
+  }
+  NTH_MEASURE() {
+    concurrent_flyweight_set<std::string> concurrent;
+    locked_flyweight_set locked;
+    NTH_TIME("sharded") { intern(concurrent, identifiers, thread_count); }
+    NTH_TIME("single-mutex") { intern(locked, identifiers, thread_count); }
+  }
+}
+
+NTH_INVOKE_TEST("concurrent_flyweight_set/benchmark/intern") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+}  // namespace
+}  // namespace nth
@@ -0,0 +1,191 @@
+#ifndef NTH_CONTAINER_CONCURRENT_STABLE_CONTAINER_H
+#define NTH_CONTAINER_CONCURRENT_STABLE_CONTAINER_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "nth/debug/debug.h"
+
+namespace nth {
+
+// A `concurrent_stable_container<T>` is a thread-safe, append-only sequence of
+// elements of type `T`. As with `stable_container`, each element is given an
+// address which never changes for the lifetime of the container, and an index
+// reflecting the order in which its slot was reserved.
+//
+// Any number of threads may insert concurrently without taking a lock: each
+// insertion reserves a slot with a single atomic increment, and storage is
+// allocated in chunks, each twice the size of the one before it, installed
+// with a compare-and-swap. Once an element has been constructed it is
+// published with a release store to a flag belonging to that element alone,
+// so readers never wait on writers of other elements. Readers may access any
+// published element without a lock.
+//
+// Published elements are only ever accessed through const references by
+// readers. Any mutation of an element after insertion must be synchronized by
+// the caller.
+template <typename T>
+struct concurrent_stable_container {
+  using value_type = T;
+  using size_type  = size_t;
+
+  struct entry_type;
+
+  concurrent_stable_container() = default;
+  concurrent_stable_container(concurrent_stable_container const&) = delete;
+  concurrent_stable_container& operator=(concurrent_stable_container const&) =
+      delete;
+
+  // Destroys all published elements. No other thread may be accessing the
+  // container.
+  ~concurrent_stable_container();
+
+  // Returns the number of slots reserved. While other threads are inserting,
+  // this may include elements which have not yet been published.
+  [[nodiscard]] size_type size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  entry_type insert(value_type const& v) { return emplace(v); }
+  entry_type insert(value_type&& v) { return emplace(std::move(v)); }
+
+  // Constructs an element from `args` in the next available slot and publishes
+  // it. If construction throws, the slot is never published, and `published`
+  // and `get` report it as absent.
+  template <typename... Args>
+  entry_type emplace(Args&&... args)
+    requires std::constructible_from<T, Args...>;
+
+  // Returns whether the element at `index` has been published.
+  [[nodiscard]] bool published(size_type index) const {
+    return get(index) != nullptr;
+  }
+
+  // Returns a pointer to the element at `index` if it has been published, and a
+  // null pointer otherwise.
+  [[nodiscard]] value_type const* get(size_type index) const;
+
+  // Returns a reference to the element at `index`. Behavior is undefined unless
+  // the element has been published.
+  [[nodiscard]] value_type const& operator[](size_type index) const {
+    value_type const* p = get(index);
+    NTH_REQUIRE((harden), p != nullptr);
+    return *p;
+  }
+
+ private:
+  static constexpr size_t FirstChunkSizeLog2 = 5;
+
+  struct slot {
+    alignas(value_type) std::byte storage[sizeof(value_type)];
+    std::atomic<bool> ready{false};
+
+    value_type* value() {
+      return std::launder(reinterpret_cast<value_type*>(storage));
+    }
+    value_type const* value() const {
+      return std::launder(reinterpret_cast<value_type const*>(storage));
+    }
+  };
+
+  // Chunk 0 holds indices in [0, 2^B), and chunk `k > 0` holds indices in
+  // [2^(B+k-1), 2^(B+k)), where `B` is `FirstChunkSizeLog2`.
+  static std::pair<size_t, size_t> locate(size_t n) {
+    if (n < (size_t{1} << FirstChunkSizeLog2)) { return {0, n}; }
+    size_t width = std::bit_width(n);
+    return {width - FirstChunkSizeLog2, n - (size_t{1} << (width - 1))};
+  }
+
+  static size_t chunk_size(size_t k) {
+    return size_t{1} << (k == 0 ? FirstChunkSizeLog2
+                                : FirstChunkSizeLog2 + k - 1);
+  }
+
+  // Returns chunk `k`, allocating it if no other thread has done so already.
+  slot* chunk(size_t k);
+
+  std::atomic<size_t> size_ = 0;
+  std::array<std::atomic<slot*>,
+             std::numeric_limits<size_t>::digits - FirstChunkSizeLog2 + 1>
+      chunks_ = {};
+};
+
+template <typename T>
+struct concurrent_stable_container<T>::entry_type {
+  value_type& operator*() const { return *ptr_; }
+  value_type* operator->() const { return ptr_; }
+
+  size_t index() const { return index_; }
+
+ private:
+  friend concurrent_stable_container;
+  entry_type(value_type* ptr, size_t index) : ptr_(ptr), index_(index) {}
+  value_type* ptr_;
+  size_t index_;
+};
+
+template <typename T>
+concurrent_stable_container<T>::~concurrent_stable_container() {
+  for (size_t k = 0; k < chunks_.size(); ++k) {
+    slot* s = chunks_[k].load(std::memory_order_acquire);
+    if (s == nullptr) { continue; }
+    for (size_t i = 0; i < chunk_size(k); ++i) {
+      if (s[i].ready.load(std::memory_order_relaxed)) {
+        std::destroy_at(s[i].value());
+      }
+    }
+    delete[] s;
+  }
+}
+
+template <typename T>
+template <typename... Args>
+concurrent_stable_container<T>::entry_type
+concurrent_stable_container<T>::emplace(Args&&... args)
+  requires std::constructible_from<T, Args...>
+{
+  size_t index     = size_.fetch_add(1, std::memory_order_relaxed);
+  auto [k, offset] = locate(index);
+  slot& s          = chunk(k)[offset];
+  value_type* p    = std::construct_at(
+      reinterpret_cast<value_type*>(s.storage), std::forward<Args>(args)...);
+  s.ready.store(true, std::memory_order_release);
+  return entry_type(p, index);
+}
+
+template <typename T>
+concurrent_stable_container<T>::value_type const*
+concurrent_stable_container<T>::get(size_type index) const {
+  if (index >= size()) { return nullptr; }
+  auto [k, offset]  = locate(index);
+  slot const* slots = chunks_[k].load(std::memory_order_acquire);
+  if (slots == nullptr) { return nullptr; }
+  slot const& s = slots[offset];
+  return s.ready.load(std::memory_order_acquire) ? s.value() : nullptr;
+}
+
+template <typename T>
+concurrent_stable_container<T>::slot* concurrent_stable_container<T>::chunk(
+    size_t k) {
+  slot* s = chunks_[k].load(std::memory_order_acquire);
+  if (s != nullptr) [[likely]] { return s; }
+  slot* allocated = new slot[chunk_size(k)];
+  if (chunks_[k].compare_exchange_strong(s, allocated,
+                                         std::memory_order_acq_rel)) {
+    return allocated;
+  }
+  delete[] allocated;
+  return s;
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_CONCURRENT_STABLE_CONTAINER_H
@@ -0,0 +1,145 @@
+#include "nth/container/concurrent_stable_container.h"
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("concurrent_stable_container/default-construction") {
+  concurrent_stable_container<std::string> c;
+  NTH_EXPECT(c.empty());
+  NTH_EXPECT(c.size() == size_t{0});
+  NTH_EXPECT(c.get(0) == nullptr);
+  NTH_EXPECT(not c.published(0));
+}
+
+NTH_TEST("concurrent_stable_container/insert") {
+  concurrent_stable_container<std::string> c;
+  auto a = c.insert("a");
+  NTH_EXPECT(a.index() == size_t{0});
+  NTH_EXPECT(*a == "a");
+  std::string s = "b";
+  auto b = c.insert(std::move(s));
+  NTH_EXPECT(b.index() == size_t{1});
+  auto d = c.emplace(3, 'd');
+  NTH_EXPECT(*d == "ddd");
+
+  NTH_EXPECT(c.size() == size_t{3});
+  NTH_EXPECT(c[0] == "a");
+  NTH_EXPECT(c[1] == "b");
+  NTH_EXPECT(c[2] == "ddd");
+  NTH_EXPECT(c.get(1) == &*b);
+  NTH_EXPECT(c.get(3) == nullptr);
+}
+
+NTH_TEST("concurrent_stable_container/address-stability") {
+  concurrent_stable_container<size_t> c;
+  std::vector<size_t const*> pointers;
+  for (size_t i = 0; i < 10000; ++i) { pointers.push_back(&*c.insert(i)); }
+  for (size_t i = 0; i < 10000; ++i) {
+    NTH_ASSERT(c.get(i) == pointers[i]);
+    NTH_ASSERT(c[i] == i);
+  }
+}
+
+struct throws_on_negative {
+  explicit throws_on_negative(int n) : value(n) {
+    if (n < 0) { throw std::runtime_error("negative"); }
+  }
+  int value;
+};
+
+NTH_TEST("concurrent_stable_container/throwing-constructor") {
+  concurrent_stable_container<throws_on_negative> c;
+  c.emplace(1);
+  try {
+    c.emplace(-1);
+  } catch (std::runtime_error const&) {}
+  c.emplace(3);
+  NTH_EXPECT(c.size() == size_t{3});
+  NTH_EXPECT(c.published(0));
+  NTH_EXPECT(not c.published(1));
+  NTH_EXPECT(c.published(2));
+  NTH_EXPECT(c[2].value == 3);
+}
+
+NTH_TEST("concurrent_stable_container/threads") {
+  constexpr size_t ThreadCount = 8;
+  constexpr size_t ValueCount  = 5000;
+  concurrent_stable_container<std::string> c;
+  std::vector<std::vector<size_t>> indices(ThreadCount);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < ThreadCount; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < ValueCount; ++i) {
+        indices[t].push_back(
+            c.insert(std::to_string(t * ValueCount + i)).index());
+        // Readers may observe any element another thread has published.
+        for (size_t j = 0; j < c.size(); j += 97) {
+          if (std::string const* s = c.get(j)) { nth::DoNotOptimize(s); }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  NTH_ASSERT(c.size() == ThreadCount * ValueCount);
+  for (size_t t = 0; t < ThreadCount; ++t) {
+    for (size_t i = 0; i < ValueCount; ++i) {
+      NTH_ASSERT(c[indices[t][i]] == std::to_string(t * ValueCount + i));
+    }
+  }
+}
+
+// Has each of `thread_count` threads append `count` values, either to a
+// `concurrent_stable_container` or to a vector of `std::unique_ptr`s guarded by
+// a single mutex.
+template <typename Container>
+void append(Container& c, size_t count, size_t thread_count) {
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < count; ++i) {
+        auto result = c.insert(i);
+        nth::DoNotOptimize(result);
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+}
+
+struct locked_vector {
+  size_t insert(size_t n) {
+    std::lock_guard lock(mutex);
+    values.push_back(std::make_unique<size_t>(n));
+    return values.size() - 1;
+  }
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<size_t>> values;
+};
+
+NTH_TEST("concurrent_stable_container/benchmark/append",
+         size_t thread_count) {
+  NTH_MEASURE() {
+    concurrent_stable_container<size_t> concurrent;
+    locked_vector locked;
+    NTH_TIME("lock-free") { append(concurrent, 4096, thread_count); }
+    NTH_TIME("single-mutex") { append(locked, 4096, thread_count); }
+  }
+}
+
+NTH_INVOKE_TEST("concurrent_stable_container/benchmark/append") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+}  // namespace
+}  // namespace nth
@@ -0,0 +1,114 @@
+#ifndef NTH_CONTAINER_DENSE_DISJOINT_SET_H
+#define NTH_CONTAINER_DENSE_DISJOINT_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "nth/debug/debug.h"
+
+namespace nth {
+
+// A `dense_disjoint_set` is a `disjoint_set` specialized to elements which are
+// the integers in `[0, size())`, such as the indices of vertices in a graph.
+// Elements serve as their own handles.
+//
+// Parents and subset sizes are stored in two flat arrays of `uint32_t`, so
+// each element costs eight bytes and no allocation beyond the arrays
+// themselves. Representatives are found iteratively with path halving, which
+// needs no stack space regardless of how long a path has grown, and subsets
+// are joined by size so that paths stay logarithmic in length.
+struct dense_disjoint_set {
+  using value_type = uint32_t;
+
+  // Constructs an empty `dense_disjoint_set`.
+  dense_disjoint_set() = default;
+
+  // Constructs a `dense_disjoint_set` containing the elements in
+  // `[0, count)`, each in a separate subset.
+  explicit dense_disjoint_set(size_t count) { insert(count); }
+
+  // Appends `count` elements to the set, each in a separate subset. Returns the
+  // first of the newly inserted elements.
+  value_type insert(size_t count = 1) {
+    size_t first = parents_.size();
+    NTH_REQUIRE((harden),
+                count <= std::numeric_limits<value_type>::max() - first);
+    parents_.resize(first + count);
+    std::iota(parents_.begin() + first, parents_.end(),
+              static_cast<value_type>(first));
+    sizes_.resize(first + count, 1);
+    subset_count_ += count;
+    return static_cast<value_type>(first);
+  }
+
+  // Reserves space for `count` elements.
+  void reserve(size_t count) {
+    parents_.reserve(count);
+    sizes_.reserve(count);
+  }
+
+  // Returns a representative of the subset containing `v`. Behavior is
+  // undefined if `v` is not an element of the set.
+  value_type representative(value_type v) {
+    NTH_REQUIRE((debug), v < size());
+    while (parents_[v] != v) {
+      value_type grandparent = parents_[parents_[v]];
+      parents_[v]            = grandparent;
+      v                      = grandparent;
+    }
+    return v;
+  }
+
+  // After invocation, `a` and `b` will be contained in the same subset. Returns
+  // the representative of the newly formed subset.
+  value_type join(value_type a, value_type b) {
+    a = representative(a);
+    b = representative(b);
+    if (a == b) { return a; }
+    if (sizes_[a] < sizes_[b]) { std::swap(a, b); }
+    parents_[b] = a;
+    sizes_[a] += sizes_[b];
+    --subset_count_;
+    return a;
+  }
+
+  // Joins the subsets containing the two elements of each pair in `edges`.
+  template <std::ranges::input_range R>
+  void join(R&& edges) {
+    for (auto const& [a, b] : edges) {
+      join(static_cast<value_type>(a), static_cast<value_type>(b));
+    }
+  }
+
+  // Returns whether `a` and `b` are contained in the same subset.
+  bool same_subset(value_type a, value_type b) {
+    return representative(a) == representative(b);
+  }
+
+  // Returns the number of elements in the subset containing `v`.
+  size_t subset_size(value_type v) { return sizes_[representative(v)]; }
+
+  // Returns the number of disjoint subsets.
+  size_t subset_count() const { return subset_count_; }
+
+  // Returns whether or not the set is empty.
+  bool empty() const { return parents_.empty(); }
+
+  // Returns the number of elements in the set (not the number of subsets).
+  size_t size() const { return parents_.size(); }
+
+ private:
+  std::vector<value_type> parents_;
+  // Only meaningful at representatives.
+  std::vector<value_type> sizes_;
+  size_t subset_count_ = 0;
+};
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_DENSE_DISJOINT_SET_H
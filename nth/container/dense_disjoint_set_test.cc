@@ -0,0 +1,125 @@
+#include "nth/container/dense_disjoint_set.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "nth/container/disjoint_set.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("dense_disjoint_set/empty") {
+  dense_disjoint_set set;
+  NTH_EXPECT(set.empty());
+  NTH_EXPECT(set.size() == 0u);
+  NTH_EXPECT(set.subset_count() == 0u);
+}
+
+NTH_TEST("dense_disjoint_set/insert") {
+  dense_disjoint_set set(3);
+  NTH_EXPECT(not set.empty());
+  NTH_EXPECT(set.size() == 3u);
+  NTH_EXPECT(set.subset_count() == 3u);
+  NTH_EXPECT(set.insert() == 3u);
+  NTH_EXPECT(set.insert(2) == 4u);
+  NTH_EXPECT(set.size() == 6u);
+  NTH_EXPECT(set.subset_count() == 6u);
+  for (uint32_t i = 0; i < 6; ++i) {
+    NTH_EXPECT(set.representative(i) == i);
+    NTH_EXPECT(set.subset_size(i) == 1u);
+  }
+}
+
+NTH_TEST("dense_disjoint_set/join") {
+  dense_disjoint_set set(4);
+  uint32_t r = set.join(0, 1);
+  NTH_EXPECT(r == 0u or r == 1u);
+  NTH_EXPECT(set.same_subset(0, 1));
+  NTH_EXPECT(not set.same_subset(0, 2));
+  NTH_EXPECT(not set.same_subset(2, 3));
+  NTH_EXPECT(set.subset_size(1) == 2u);
+  NTH_EXPECT(set.subset_count() == 3u);
+
+  NTH_EXPECT(set.join(1, 0) == set.representative(0));
+  NTH_EXPECT(set.subset_count() == 3u);
+
+  set.join(2, 3);
+  set.join(3, 1);
+  for (uint32_t i = 0; i < 4; ++i) {
+    NTH_EXPECT(set.representative(i) == set.representative(0));
+  }
+  NTH_EXPECT(set.subset_size(2) == 4u);
+  NTH_EXPECT(set.subset_count() == 1u);
+}
+
+NTH_TEST("dense_disjoint_set/join-edges") {
+  dense_disjoint_set set(8);
+  std::vector<std::pair<uint32_t, uint32_t>> edges = {
+      {0, 1}, {2, 3}, {1, 3}, {5, 6}, {6, 7}};
+  set.join(edges);
+  NTH_EXPECT(set.subset_count() == 3u);
+  NTH_EXPECT(set.same_subset(0, 2));
+  NTH_EXPECT(set.same_subset(5, 7));
+  NTH_EXPECT(not set.same_subset(3, 4));
+  NTH_EXPECT(not set.same_subset(4, 5));
+  NTH_EXPECT(set.subset_size(4) == 1u);
+  NTH_EXPECT(set.subset_size(6) == 3u);
+}
+
+NTH_TEST("dense_disjoint_set/long-chain") {
+  // Joining in this order would produce a path as long as the set without
+  // union by size; neither it nor path halving may use the stack.
+  constexpr uint32_t Count = 1 << 20;
+  dense_disjoint_set set(Count);
+  for (uint32_t i = 1; i < Count; ++i) { set.join(i - 1, i); }
+  NTH_EXPECT(set.subset_count() == 1u);
+  NTH_EXPECT(set.subset_size(Count - 1) == Count);
+  NTH_EXPECT(set.same_subset(0, Count - 1));
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> RandomEdges(uint32_t vertex_count,
+                                                       size_t edge_count) {
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  edges.reserve(edge_count);
+  uint64_t state = 1;
+  auto next      = [&] {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    return static_cast<uint32_t>((state >> 32) % vertex_count);
+  };
+  for (size_t i = 0; i < edge_count; ++i) {
+    uint32_t a = next();
+    edges.emplace_back(a, next());
+  }
+  return edges;
+}
+
+NTH_TEST("dense_disjoint_set/benchmark/connected-components",
+         uint32_t vertex_count) {
+  auto edges = RandomEdges(vertex_count, vertex_count);
+  NTH_MEASURE() {
+    NTH_TIME("dense_disjoint_set") {
+      dense_disjoint_set set(vertex_count);
+      set.join(edges);
+      size_t count = set.subset_count();
+      nth::DoNotOptimize(count);
+    }
+    NTH_TIME("disjoint_set") {
+      disjoint_set<uint32_t> set;
+      for (uint32_t v = 0; v < vertex_count; ++v) { set.insert(v); }
+      for (auto [a, b] : edges) { set.join(set.find(a), set.find(b)); }
+      size_t size = set.size();
+      nth::DoNotOptimize(size);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("dense_disjoint_set/benchmark/connected-components") {
+  co_yield uint32_t{1} << 10;
+  co_yield uint32_t{1} << 20;
+}
+
+}  // namespace
+}  // namespace nth
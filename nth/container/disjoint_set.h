@@ -176,9 +176,15 @@ typename disjoint_set<T>::handle disjoint_set<T>::representative(handle h) {
 template <typename T>
 typename disjoint_set<T>::handle disjoint_set<T>::representative_impl(
     handle h) {
-  handle &parent = h.parent();
-  if (parent == h) { return h; }
-  return parent = representative_impl(parent);
+  // Path halving: each visited element is pointed at its grandparent. Unlike
+  // full path compression, this needs no stack space however long the path.
+  while (true) {
+    handle &parent = h.parent();
+    if (parent == h) { return h; }
+    handle grandparent = parent.parent();
+    parent             = grandparent;
+    h                  = grandparent;
+  }
 }
 
 }  // namespace nth
@@ -1,15 +1,219 @@
 #ifndef NTH_CONTAINER_FLAT_FOREST_H
 #define NTH_CONTAINER_FLAT_FOREST_H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "nth/debug/debug.h"
 #include "nth/utility/iterator_range.h"
 
 namespace nth {
+
+struct flat_forest_options {
+  // When set, subtree sizes are stored as `uint32_t` in an array separate from
+  // the array of values, rather than alongside each value. Operations which
+  // only inspect the shape of the forest (e.g., iterating over roots or
+  // children) then touch only the compact array of sizes, which is worthwhile
+  // when values are large. Forests with this option set may hold fewer than
+  // 2^32 nodes.
+  bool separate_subtree_sizes = false;
+};
+
 namespace internal_flat_forest {
 
 struct sentinel_iterator {};
 
+template <typename T>
+struct node {
+  template <typename... Args>
+  explicit node(size_t subtree_size, Args &&...args)
+      : subtree_size(subtree_size), value(std::forward<Args>(args)...) {}
+
+  size_t subtree_size;
+  T value;
+};
+
+// A position within the nodes of a forest, supporting pointer-like arithmetic,
+// for forests storing each value alongside its subtree size.
+template <typename T, bool Const>
+struct packed_cursor {
+  using node_type = std::conditional_t<Const, node<T> const, node<T>>;
+
+  size_t subtree_size() const { return ptr->subtree_size; }
+  auto &value() const { return ptr->value; }
+
+  packed_cursor &operator++() {
+    ++ptr;
+    return *this;
+  }
+  packed_cursor &operator+=(ptrdiff_t n) {
+    ptr += n;
+    return *this;
+  }
+  packed_cursor &operator-=(ptrdiff_t n) {
+    ptr -= n;
+    return *this;
+  }
+  friend packed_cursor operator+(packed_cursor c, ptrdiff_t n) {
+    return c += n;
+  }
+  friend packed_cursor operator-(packed_cursor c, ptrdiff_t n) {
+    return c -= n;
+  }
+  friend ptrdiff_t operator-(packed_cursor lhs, packed_cursor rhs) {
+    return lhs.ptr - rhs.ptr;
+  }
+  friend bool operator==(packed_cursor, packed_cursor) = default;
+
+  node_type *ptr = nullptr;
+};
+
+// A position within the nodes of a forest, supporting pointer-like arithmetic,
+// for forests storing subtree sizes and values in separate arrays.
+template <typename T, bool Const>
+struct split_cursor {
+  size_t subtree_size() const { return *size; }
+  auto &value() const { return *val; }
+
+  split_cursor &operator++() {
+    ++size;
+    ++val;
+    return *this;
+  }
+  split_cursor &operator+=(ptrdiff_t n) {
+    size += n;
+    val += n;
+    return *this;
+  }
+  split_cursor &operator-=(ptrdiff_t n) {
+    size -= n;
+    val -= n;
+    return *this;
+  }
+  friend split_cursor operator+(split_cursor c, ptrdiff_t n) { return c += n; }
+  friend split_cursor operator-(split_cursor c, ptrdiff_t n) { return c -= n; }
+  friend ptrdiff_t operator-(split_cursor lhs, split_cursor rhs) {
+    return lhs.size - rhs.size;
+  }
+  friend bool operator==(split_cursor lhs, split_cursor rhs) {
+    return lhs.size == rhs.size;
+  }
+
+  uint32_t const *size = nullptr;
+  std::conditional_t<Const, T const, T> *val = nullptr;
+};
+
+template <typename T>
+struct packed_storage {
+  template <bool Const>
+  using cursor = packed_cursor<T, Const>;
+
+  size_t size() const { return nodes.size(); }
+  size_t subtree_size(size_t i) const { return nodes[i].subtree_size; }
+  T &value(size_t i) { return nodes[i].value; }
+  T const &value(size_t i) const { return nodes[i].value; }
+
+  void reserve(size_t n) { nodes.reserve(n); }
+
+  template <typename... Args>
+  void emplace_back(size_t subtree_size, Args &&...args) {
+    nodes.emplace_back(subtree_size, std::forward<Args>(args)...);
+  }
+
+  cursor<false> at(size_t i) { return {nodes.data() + i}; }
+  cursor<true> at(size_t i) const { return {nodes.data() + i}; }
+
+  std::vector<node<T>> nodes;
+};
+
+template <typename T>
+struct split_storage {
+  template <bool Const>
+  using cursor = split_cursor<T, Const>;
+
+  size_t size() const { return sizes.size(); }
+  size_t subtree_size(size_t i) const { return sizes[i]; }
+  T &value(size_t i) { return values[i]; }
+  T const &value(size_t i) const { return values[i]; }
+
+  void reserve(size_t n) {
+    sizes.reserve(n);
+    values.reserve(n);
+  }
+
+  template <typename... Args>
+  void emplace_back(size_t subtree_size, Args &&...args) {
+    NTH_REQUIRE((harden), sizes.size() < std::numeric_limits<uint32_t>::max());
+    // Make room for the size first so that, once the value has been
+    // constructed, nothing can fail and leave the arrays out of step.
+    if (sizes.size() == sizes.capacity()) {
+      sizes.reserve(std::max<size_t>(16, 2 * sizes.capacity()));
+    }
+    values.emplace_back(std::forward<Args>(args)...);
+    sizes.push_back(static_cast<uint32_t>(subtree_size));
+  }
+
+  cursor<false> at(size_t i) { return {sizes.data() + i, values.data() + i}; }
+  cursor<true> at(size_t i) const {
+    return {sizes.data() + i, values.data() + i};
+  }
+
+  std::vector<uint32_t> sizes;
+  std::vector<T> values;
+};
+
+// Grants algorithms over a `flat_forest` access to its nodes by position, where
+// the position of a node is its index in the post-order traversal.
+struct access {
+  template <typename Forest>
+  static size_t subtree_size(Forest const &f, size_t position) {
+    return f.storage_.subtree_size(position);
+  }
+
+  template <typename Forest>
+  static auto const &value(Forest const &f, size_t position) {
+    return f.storage_.value(position);
+  }
+
+  template <typename Index>
+  static size_t position(Index index) {
+    return index.index_;
+  }
+
+  template <typename Index>
+  static Index make_index(size_t position) {
+    return Index(position);
+  }
+
+  // Appends a node to `f` with the given subtree size, without checking that
+  // the size describes a valid subtree.
+  template <typename Forest, typename... Args>
+  static void emplace_back(Forest &f, size_t subtree_size, Args &&...args) {
+    f.storage_.emplace_back(subtree_size, std::forward<Args>(args)...);
+    f.structure_.reset();
+  }
+
+  template <typename Forest>
+  static void reserve(Forest &f, size_t n) {
+    f.storage_.reserve(n);
+  }
+
+  // Makes `f` share ownership of `arena`, from which values in `f` may have
+  // allocated memory.
+  template <typename Forest>
+  static void share_arena(Forest &f, std::shared_ptr<void const> arena) {
+    f.arena_ = std::move(arena);
+  }
+};
+
 }  // namespace internal_flat_forest
 
 // A `flat_forest` is a tree-like data structure that is designed to be fast to
@@ -18,10 +222,21 @@ struct sentinel_iterator {};
 // there is no guarantee that there is a unique root. The name contains "flat"
 // to indicate that all nodes are stored in contiguous storage. Broadly speaking
 // appending nodes will be fast, but deletions may be expensive.
-template <typename T>
+//
+// By default each value is stored alongside the size of its subtree. Layout may
+// be adjusted with `flat_forest_options`.
+template <typename T, flat_forest_options Options = flat_forest_options{}>
 struct flat_forest {
   using value_type = T;
 
+  static constexpr flat_forest_options options = Options;
+
+  flat_forest() = default;
+  flat_forest(flat_forest const &)     = default;
+  flat_forest(flat_forest &&) noexcept = default;
+  flat_forest &operator=(flat_forest const &f);
+  flat_forest &operator=(flat_forest &&f) noexcept;
+
   // `index_type` provides a stable accessor for entries contained in the
   // `flat_forest`, via `operator[]`. Values of type `index_type` are not
   // invalidated by append operations, but may be invalidated by deletions or
@@ -48,11 +263,17 @@ struct flat_forest {
   struct sibling_iterator;
   struct const_sibling_iterator;
 
+  // `structure_index` holds auxiliary information about the shape of the
+  // forest which cannot be read directly off of its post-order layout: each
+  // node's parent, depth and first child, along with the pre-order and
+  // level-order traversals of the forest.
+  struct structure_index;
+
   // Returns the number of nodes in the forest.
-  size_t size() const { return nodes_.size(); }
+  size_t size() const { return storage_.size(); }
 
   // Returns `true` if there are no nodes in the forsest, and `false` otherwise.
-  bool empty() const { return nodes_.empty(); }
+  bool empty() const { return size() == 0; }
 
   // Returns a reference to the `value_type` stored in the node referred to by
   // `index`.
@@ -88,91 +309,228 @@ struct flat_forest {
   auto roots() const;
   auto croots() const;
 
+  // Computes the `structure_index` for this forest in a single linear pass,
+  // unless it has already been computed since the forest was last modified,
+  // and returns it. The returned reference is invalidated by any append,
+  // insert, or deletion operation.
+  structure_index const &build_structure();
+
+  // Returns `true` if the `structure_index` has been computed since the forest
+  // was last modified, and `false` otherwise.
+  bool has_structure() const { return structure_.has_value(); }
+
+  // Returns the `structure_index` for this forest, which must already have
+  // been computed by `build_structure`. Like every other const member
+  // function, this may be called concurrently with itself.
+  structure_index const &structure() const;
+
  private:
   struct const_node_range;
   struct node_range;
 
-  struct node_type {
-    template <typename... Args>
-    node_type(size_t subtree_size,
-              Args &&...args) requires std::constructible_from<T, Args...>;
-
-   private:
-    friend flat_forest;
-    friend entry_type;
-    friend const_entry_type;
-    friend post_order_iterator;
-    friend const_post_order_iterator;
-    friend sibling_iterator;
-    friend const_sibling_iterator;
-
-    size_t subtree_size_;
-    value_type value_;
-  };
+  using storage_type =
+      std::conditional_t<Options.separate_subtree_sizes,
+                         internal_flat_forest::split_storage<T>,
+                         internal_flat_forest::packed_storage<T>>;
+  using cursor       = typename storage_type::template cursor<false>;
+  using const_cursor = typename storage_type::template cursor<true>;
+
+  // Returns a cursor referring to the last node, or a null cursor if the
+  // forest is empty.
+  cursor last() { return empty() ? cursor{} : storage_.at(size() - 1); }
+  const_cursor last() const {
+    return empty() ? const_cursor{} : storage_.at(size() - 1);
+  }
 
   [[maybe_unused]] bool IsValidCutpoint(size_t index) const;
 
-  std::vector<node_type> nodes_;
+  friend internal_flat_forest::access;
+
+  // Memory from which values may have allocated, if this forest was built by a
+  // `flat_forest_builder`. Declared before `storage_` so that it outlives the
+  // values.
+  std::shared_ptr<void const> arena_;
+  storage_type storage_;
+  std::optional<structure_index> structure_;
 };
 
-template <typename T>
-struct flat_forest<T>::index_type {
+// Assignment replaces values before releasing the arena they may have allocated
+// from, which is the opposite of the order in which members are declared.
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options> &flat_forest<T, Options>::operator=(
+    flat_forest const &f) {
+  if (this == &f) { return *this; }
+  // Copy-assigning a value may reuse its existing allocator, and therefore
+  // allocate from our arena, so copy into a fresh forest first.
+  return *this = flat_forest(f);
+}
+
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options> &flat_forest<T, Options>::operator=(
+    flat_forest &&f) noexcept {
+  if (this == &f) { return *this; }
+  storage_   = std::move(f.storage_);
+  structure_ = std::move(f.structure_);
+  arena_     = std::move(f.arena_);
+  return *this;
+}
+
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::index_type {
+  friend bool operator==(index_type, index_type) = default;
+
  private:
-  template <typename>
+  template <typename, flat_forest_options>
   friend struct flat_forest;
+  friend internal_flat_forest::access;
 
   constexpr index_type() = default;
   constexpr index_type(size_t n) : index_(n) {}
   size_t index_;
 };
 
-template <typename T>
+template <typename T, flat_forest_options Options>
 template <typename... Args>
-flat_forest<T>::index_type flat_forest<T>::append_leaf(
+flat_forest<T, Options>::index_type flat_forest<T, Options>::append_leaf(
     Args &&...args) requires std::constructible_from<T, Args...> {
-  index_type index(nodes_.size());
-  nodes_.emplace_back(1, std::forward<Args>(args)...);
+  index_type index(size());
+  storage_.emplace_back(1, std::forward<Args>(args)...);
+  structure_.reset();
   return index;
 }
 
-template <typename T>
+template <typename T, flat_forest_options Options>
 template <typename... Args>
-flat_forest<T>::index_type flat_forest<T>::append_ancestor(
+flat_forest<T, Options>::index_type flat_forest<T, Options>::append_ancestor(
     index_type index,
     Args &&...args) requires std::constructible_from<T, Args...> {
   NTH_REQUIRE((debug), IsValidCutpoint(index.index_));
-  index_type return_index(nodes_.size());
-  nodes_.emplace_back(nodes_.size() - index.index_ + 1,
-                      std::forward<Args>(args)...);
+  index_type return_index(size());
+  storage_.emplace_back(size() - index.index_ + 1,
+                        std::forward<Args>(args)...);
+  structure_.reset();
   return return_index;
 }
 
-template <typename T>
-template <typename... Args>
-flat_forest<T>::node_type::node_type(
-    size_t subtree_size,
-    Args &&...args) requires std::constructible_from<T, Args...>
-    : subtree_size_(subtree_size), value_(std::forward<Args>(args)...) {}
-
 struct post_order_traversal_t {};
 inline constexpr post_order_traversal_t post_order;
 
-template <typename T>
-struct flat_forest<T>::const_entry_type {
+struct pre_order_traversal_t {};
+inline constexpr pre_order_traversal_t pre_order;
+
+struct level_order_traversal_t {};
+inline constexpr level_order_traversal_t level_order;
+
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::structure_index {
+  // Returns the index of the parent of the node referred to by `index`, or
+  // `std::nullopt` if the node is a root.
+  std::optional<index_type> parent(index_type index) const {
+    size_t p = parents_[index.index_];
+    if (p == None) { return std::nullopt; }
+    return index_type(p);
+  }
+
+  // Returns the number of ancestors of the node referred to by `index`. Roots
+  // have depth zero.
+  size_t depth(index_type index) const { return depths_[index.index_]; }
+
+  // Returns the index of the first child appended to the node referred to by
+  // `index`, or `std::nullopt` if the node is a leaf.
+  std::optional<index_type> first_child(index_type index) const {
+    size_t c = first_children_[index.index_];
+    if (c == None) { return std::nullopt; }
+    return index_type(c);
+  }
+
+  // Returns a range over the indices of all nodes in the forest in pre-order:
+  // each node precedes its descendants, and siblings appear in the order in
+  // which they were appended.
+  auto nodes(pre_order_traversal_t) const { return indices(pre_order_); }
+
+  // Returns a range over the indices of all nodes in the forest in level-order:
+  // nodes appear in order of increasing depth, and nodes of equal depth appear
+  // in the order in which they were appended.
+  auto nodes(level_order_traversal_t) const { return indices(level_order_); }
+
+ private:
+  friend flat_forest;
+
+  static constexpr size_t None = std::numeric_limits<size_t>::max();
+
+  explicit structure_index(storage_type const &nodes);
+
+  static auto indices(std::vector<size_t> const &v) {
+    return v | std::views::transform([](size_t n) { return index_type(n); });
+  }
+
+  std::vector<size_t> parents_;
+  std::vector<size_t> depths_;
+  std::vector<size_t> first_children_;
+  std::vector<size_t> pre_order_;
+  std::vector<size_t> level_order_;
+};
+
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::structure_index::structure_index(
+    storage_type const &nodes)
+    : parents_(nodes.size(), None),
+      depths_(nodes.size()),
+      first_children_(nodes.size(), None),
+      pre_order_(nodes.size()),
+      level_order_(nodes.size()) {
+  // Walking backwards visits each node before its descendants, with siblings
+  // in reverse order. `ancestors` holds the nodes whose subtrees contain the
+  // current node. Because later children are visited first, the last child
+  // visited for each node is its first child.
+  std::vector<size_t> ancestors;
+  size_t max_depth = 0;
+  for (size_t i = nodes.size(); i-- > 0;) {
+    while (not ancestors.empty() and
+           ancestors.back() + 1 - nodes.subtree_size(ancestors.back()) > i) {
+      ancestors.pop_back();
+    }
+    if (not ancestors.empty()) {
+      parents_[i]                       = ancestors.back();
+      first_children_[ancestors.back()] = i;
+    }
+    depths_[i] = ancestors.size();
+    max_depth  = std::max(max_depth, depths_[i]);
+    ancestors.push_back(i);
+
+    // A node is preceded in pre-order by everything preceding its subtree in
+    // post-order, as well as by its ancestors.
+    pre_order_[i + 1 - nodes.subtree_size(i) + depths_[i]] = i;
+  }
+
+  // Level-order is a stable counting sort of the post-order by depth.
+  if (nodes.size() == 0) { return; }
+  std::vector<size_t> offsets(max_depth + 2, 0);
+  for (size_t d : depths_) { ++offsets[d + 1]; }
+  for (size_t d = 1; d < offsets.size(); ++d) { offsets[d] += offsets[d - 1]; }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    level_order_[offsets[depths_[i]]++] = i;
+  }
+}
+
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::const_entry_type {
   // Returns a reference to the `value_type` stored in this node.
-  value_type const &operator*() const { return entry_->value_; }
+  value_type const &operator*() const { return entry_.value(); }
 
-  value_type *operator->() const { return std::addressof(entry_->value_); }
+  value_type const *operator->() const {
+    return std::addressof(entry_.value());
+  }
 
   // Returns the number of nodes in subtree corresponding to this node,
   // including the node itself.
-  size_t subtree_size() const { return entry_->subtree_size_; }
+  size_t subtree_size() const { return entry_.subtree_size(); }
 
   // Returns a range over all descendants of this node (excluding the node
   // itself). Iteration through the nodes will traverse the nodes in post order.
   auto descendants(post_order_traversal_t) const {
     return nth::iterator_range(
-        const_post_order_iterator(entry_ - entry_->subtree_size_ + 1),
+        const_post_order_iterator(entry_ - entry_.subtree_size() + 1),
         const_post_order_iterator(entry_));
   }
 
@@ -180,38 +538,38 @@ struct flat_forest<T>::const_entry_type {
   // itself). Iteration through the nodes will traverse the nodes in post order.
   auto subtree(post_order_traversal_t) const {
     return nth::iterator_range(
-        const_post_order_iterator(entry_ - entry_->subtree_size_ + 1),
+        const_post_order_iterator(entry_ - entry_.subtree_size() + 1),
         const_post_order_iterator(entry_ + 1));
   }
 
   auto children() const {
     return nth::iterator_range(
-        const_sibling_iterator(entry_ - 1, entry_->subtree_size_ - 1),
+        const_sibling_iterator(entry_ - 1, entry_.subtree_size() - 1),
         internal_flat_forest::sentinel_iterator{});
   }
 
  protected:
-  friend flat_forest<T>;
-  explicit const_entry_type(node_type const *entry) : entry_(entry) {}
-  node_type const *entry_;
+  friend flat_forest<T, Options>;
+  explicit const_entry_type(const_cursor entry) : entry_(entry) {}
+  const_cursor entry_;
 };
 
-template <typename T>
-struct flat_forest<T>::entry_type {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::entry_type {
   // Returns a reference to the `value_type` stored in this node.
-  value_type &operator*() const { return entry_->value_; }
+  value_type &operator*() const { return entry_.value(); }
 
-  value_type *operator->() const { return std::addressof(entry_->value_); }
+  value_type *operator->() const { return std::addressof(entry_.value()); }
 
   // Returns the number of nodes in subtree corresponding to this node,
   // including the node itself.
-  size_t subtree_size() const { return entry_->subtree_size_; }
+  size_t subtree_size() const { return entry_.subtree_size(); }
 
   // Returns a range over all descendants of this node (excluding the node
   // itself). Iteration through the nodes will traverse the nodes in post order.
   auto descendants(post_order_traversal_t) const {
     return nth::iterator_range(
-        post_order_iterator(entry_ - entry_->subtree_size_ + 1),
+        post_order_iterator(entry_ - entry_.subtree_size() + 1),
         post_order_iterator(entry_));
   }
 
@@ -219,20 +577,20 @@ struct flat_forest<T>::entry_type {
   // itself). Iteration through the nodes will traverse the nodes in post order.
   auto subtree(post_order_traversal_t) const {
     return nth::iterator_range(
-        post_order_iterator(entry_ - entry_->subtree_size_ + 1),
+        post_order_iterator(entry_ - entry_.subtree_size() + 1),
         post_order_iterator(entry_ + 1));
   }
 
   auto children() const {
     return nth::iterator_range(
-        sibling_iterator(entry_ - 1, entry_->subtree_size_ - 1),
+        sibling_iterator(entry_ - 1, entry_.subtree_size() - 1),
         internal_flat_forest::sentinel_iterator{});
   }
 
  protected:
-  friend flat_forest<T>;
-  explicit entry_type(node_type *entry) : entry_(entry) {}
-  node_type *entry_;
+  friend flat_forest<T, Options>;
+  explicit entry_type(cursor entry) : entry_(entry) {}
+  cursor entry_;
 };
 
 namespace internal_flat_forest {
@@ -280,8 +638,7 @@ struct iterator : EntryType {
   }
 
  protected:
-  constexpr explicit iterator(auto const *ptr)
-      : EntryType(const_cast<std::remove_cvref_t<decltype(*ptr)> *>(ptr)) {}
+  constexpr explicit iterator(auto cursor) : EntryType(cursor) {}
 
  private:
   It clone() const { return self(); }
@@ -291,10 +648,10 @@ struct iterator : EntryType {
 
 }  // namespace internal_flat_forest
 
-template <typename T>
-struct flat_forest<T>::const_post_order_iterator
-    : internal_flat_forest::iterator<
-          const_entry_type, flat_forest<T>::const_post_order_iterator> {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::const_post_order_iterator
+    : internal_flat_forest::iterator<const_entry_type,
+                                     const_post_order_iterator> {
   friend ptrdiff_t operator-(const_post_order_iterator lhs,
                              const_post_order_iterator rhs) {
     return lhs.entry_ - rhs.entry_;
@@ -306,24 +663,23 @@ struct flat_forest<T>::const_post_order_iterator
   }
 
  private:
-  friend internal_flat_forest::iterator<
-      const_entry_type, flat_forest<T>::const_post_order_iterator>;
-  friend flat_forest<T>::const_entry_type;
+  friend internal_flat_forest::iterator<const_entry_type,
+                                        const_post_order_iterator>;
+  friend flat_forest<T, Options>::const_entry_type;
 
   void increment() { ++this->entry_; }
   void increment_by(int n) { this->entry_ += n; }
   void decrement() { --this->entry_; }
   void decrement_by(int n) { this->entry_ -= n; }
 
-  explicit const_post_order_iterator(node_type const *ptr)
+  explicit const_post_order_iterator(const_cursor ptr)
       : internal_flat_forest::iterator<const_entry_type,
                                        const_post_order_iterator>(ptr) {}
 };
 
-template <typename T>
-struct flat_forest<T>::post_order_iterator
-    : internal_flat_forest::iterator<entry_type,
-                                     flat_forest<T>::post_order_iterator> {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::post_order_iterator
+    : internal_flat_forest::iterator<entry_type, post_order_iterator> {
   friend ptrdiff_t operator-(post_order_iterator lhs, post_order_iterator rhs) {
     return lhs.entry_ - rhs.entry_;
   }
@@ -333,23 +689,22 @@ struct flat_forest<T>::post_order_iterator
   }
 
  private:
-  friend internal_flat_forest::iterator<entry_type,
-                                        flat_forest<T>::post_order_iterator>;
-  friend flat_forest<T>::entry_type;
+  friend internal_flat_forest::iterator<entry_type, post_order_iterator>;
+  friend flat_forest<T, Options>::entry_type;
 
   void increment() { ++this->entry_; }
   void increment_by(int n) { this->entry_ += n; }
   void decrement() { --this->entry_; }
   void decrement_by(int n) { this->entry_ -= n; }
 
-  explicit post_order_iterator(node_type *ptr)
+  explicit post_order_iterator(cursor ptr)
       : internal_flat_forest::iterator<entry_type, post_order_iterator>(ptr) {}
 };
 
-template <typename T>
-struct flat_forest<T>::const_sibling_iterator
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::const_sibling_iterator
     : internal_flat_forest::iterator<const_entry_type,
-                                     flat_forest<T>::const_sibling_iterator> {
+                                     const_sibling_iterator> {
   friend bool operator==(const_sibling_iterator lhs,
                          internal_flat_forest::sentinel_iterator) {
     return lhs.n_ == 0;
@@ -357,57 +712,55 @@ struct flat_forest<T>::const_sibling_iterator
 
  private:
   friend internal_flat_forest::iterator<const_entry_type,
-                                        flat_forest<T>::const_sibling_iterator>;
-  friend flat_forest<T>;
-  friend flat_forest<T>::const_entry_type;
+                                        const_sibling_iterator>;
+  friend flat_forest<T, Options>;
+  friend flat_forest<T, Options>::const_entry_type;
 
   void increment() {
-    n_ -= this->entry_->subtree_size_;
-    this->entry_ -= this->entry_->subtree_size_;
+    n_ -= this->entry_.subtree_size();
+    this->entry_ -= this->entry_.subtree_size();
   }
   void increment_by(int n) {
-    for (int i = 0; i < n; ++i) { ++n; }
+    for (int i = 0; i < n; ++i) { increment(); }
   }
 
-  explicit const_sibling_iterator(node_type const *ptr, size_t n)
+  explicit const_sibling_iterator(const_cursor ptr, size_t n)
       : internal_flat_forest::iterator<const_entry_type,
                                        const_sibling_iterator>(ptr),
         n_(n) {}
   size_t n_;
 };
 
-template <typename T>
-struct flat_forest<T>::sibling_iterator
-    : internal_flat_forest::iterator<entry_type,
-                                     flat_forest<T>::sibling_iterator> {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::sibling_iterator
+    : internal_flat_forest::iterator<entry_type, sibling_iterator> {
   friend bool operator==(sibling_iterator lhs,
                          internal_flat_forest::sentinel_iterator) {
     return lhs.n_ == 0;
   }
 
  private:
-  friend internal_flat_forest::iterator<entry_type,
-                                        flat_forest<T>::sibling_iterator>;
-  friend flat_forest<T>;
-  friend flat_forest<T>::entry_type;
+  friend internal_flat_forest::iterator<entry_type, sibling_iterator>;
+  friend flat_forest<T, Options>;
+  friend flat_forest<T, Options>::entry_type;
 
   void increment() {
-    n_ -= this->entry_->subtree_size_;
-    this->entry_ -= this->entry_->subtree_size_;
+    n_ -= this->entry_.subtree_size();
+    this->entry_ -= this->entry_.subtree_size();
   }
   void increment_by(int n) {
-    for (int i = 0; i < n; ++i) { ++n; }
+    for (int i = 0; i < n; ++i) { increment(); }
   }
 
-  explicit sibling_iterator(node_type *ptr, size_t n)
+  explicit sibling_iterator(cursor ptr, size_t n)
       : internal_flat_forest::iterator<entry_type, sibling_iterator>(ptr),
         n_(n) {}
 
   size_t n_;
 };
 
-template <typename T>
-struct flat_forest<T>::const_node_range {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::const_node_range {
   explicit const_node_range(const_entry_type low, const_entry_type high)
       : low_(low), high_(high) {}
 
@@ -418,8 +771,8 @@ struct flat_forest<T>::const_node_range {
   const_entry_type low_, high_;
 };
 
-template <typename T>
-struct flat_forest<T>::node_range {
+template <typename T, flat_forest_options Options>
+struct flat_forest<T, Options>::node_range {
   explicit node_range(entry_type low, entry_type high)
       : low_(low), high_(high) {}
 
@@ -430,62 +783,76 @@ struct flat_forest<T>::node_range {
   entry_type low_, high_;
 };
 
-template <typename T>
-flat_forest<T>::value_type const &flat_forest<T>::operator[](
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::value_type const &flat_forest<T, Options>::operator[](
     index_type index) const {
-  return nodes_[index.index_].value_;
+  return storage_.value(index.index_);
 }
 
-template <typename T>
-flat_forest<T>::value_type &flat_forest<T>::operator[](index_type index) {
-  return nodes_[index.index_].value_;
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::value_type &flat_forest<T, Options>::operator[](
+    index_type index) {
+  return storage_.value(index.index_);
 }
 
-template <typename T>
-flat_forest<T>::const_entry_type flat_forest<T>::entry(index_type index) const {
-  return const_entry_type(&nodes_[index.index_]);
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::const_entry_type flat_forest<T, Options>::entry(
+    index_type index) const {
+  return const_entry_type(storage_.at(index.index_));
 }
 
-template <typename T>
-flat_forest<T>::entry_type flat_forest<T>::entry(index_type index) {
-  return entry_type(&nodes_[index.index_]);
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::entry_type flat_forest<T, Options>::entry(
+    index_type index) {
+  return entry_type(storage_.at(index.index_));
 }
 
-template <typename T>
-flat_forest<T>::const_entry_type flat_forest<T>::centry(
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::const_entry_type flat_forest<T, Options>::centry(
     index_type index) const {
-  return const_entry_type(&nodes_[index.index_]);
+  return const_entry_type(storage_.at(index.index_));
 }
 
-template <typename T>
-bool flat_forest<T>::IsValidCutpoint(size_t index) const {
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::structure_index const &
+flat_forest<T, Options>::build_structure() {
+  if (not structure_) { structure_.emplace(structure_index(storage_)); }
+  return *structure_;
+}
+
+template <typename T, flat_forest_options Options>
+flat_forest<T, Options>::structure_index const &
+flat_forest<T, Options>::structure() const {
+  NTH_REQUIRE((harden), structure_.has_value());
+  return *structure_;
+}
+
+template <typename T, flat_forest_options Options>
+bool flat_forest<T, Options>::IsValidCutpoint(size_t index) const {
   NTH_REQUIRE((debug), not empty());
-  size_t loc = nodes_.size();
-  while (loc > index) { loc -= nodes_[loc - 1].subtree_size_; }
+  size_t loc = size();
+  while (loc > index) { loc -= storage_.subtree_size(loc - 1); }
   return loc == index;
 }
 
-template <typename T>
-auto flat_forest<T>::roots() {
+template <typename T, flat_forest_options Options>
+auto flat_forest<T, Options>::roots() {
   return nth::iterator_range(
-      sibling_iterator(nodes_.empty() ? nullptr : &nodes_.back(),
-                       nodes_.size()),
+      sibling_iterator(last(), size()),
       internal_flat_forest::sentinel_iterator{});
 }
 
-template <typename T>
-auto flat_forest<T>::roots() const {
+template <typename T, flat_forest_options Options>
+auto flat_forest<T, Options>::roots() const {
   return nth::iterator_range(
-      const_sibling_iterator(nodes_.empty() ? nullptr : &nodes_.back(),
-                             nodes_.size()),
+      const_sibling_iterator(last(), size()),
       internal_flat_forest::sentinel_iterator{});
 }
 
-template <typename T>
-auto flat_forest<T>::croots() const {
+template <typename T, flat_forest_options Options>
+auto flat_forest<T, Options>::croots() const {
   return nth::iterator_range(
-      const_sibling_iterator(nodes_.empty() ? nullptr : &nodes_.back(),
-                             nodes_.size()),
+      const_sibling_iterator(last(), size()),
       internal_flat_forest::sentinel_iterator{});
 }
 
@@ -0,0 +1,154 @@
+#ifndef NTH_CONTAINER_FLAT_FOREST_BUILDER_H
+#define NTH_CONTAINER_FLAT_FOREST_BUILDER_H
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+
+#include "nth/container/flat_forest.h"
+#include "nth/container/internal/chunked_vector.h"
+#include "nth/debug/debug.h"
+
+namespace nth {
+namespace internal_flat_forest {
+
+template <typename T>
+struct builder_node {
+  // Constructs `value` from a tuple of arguments, as produced by
+  // `std::uses_allocator_construction_args`, without an intervening move.
+  template <typename Tuple>
+  explicit builder_node(size_t subtree_size, Tuple &&args)
+      : subtree_size(subtree_size),
+        value(std::make_from_tuple<T>(std::forward<Tuple>(args))) {}
+
+  size_t subtree_size;
+  T value;
+};
+
+}  // namespace internal_flat_forest
+
+// A `flat_forest_builder` constructs a `flat_forest` incrementally, with the
+// same `append_leaf` and `append_ancestor` interface, for workloads such as
+// parsing where a forest is built once and then only read.
+//
+// Two costs of appending directly to a `flat_forest` are avoided. First, nodes
+// are held in fixed-size chunks, so growing the builder never moves existing
+// nodes. Second, the builder owns a monotonic arena. Values of a type `T` which
+// uses `allocator_type` (e.g., `std::pmr::string` or `std::pmr::vector`) are
+// constructed with it, so that their allocations are carved out of large
+// blocks and are never individually freed.
+//
+// Once all nodes have been appended, `finalize` moves them into a `flat_forest`
+// in a single contiguous allocation. The forest shares ownership of the arena,
+// which is released only once the forest and every copy or moved-to forest
+// sharing it have been destroyed. Values moved out of the forest keep using the
+// arena, and must not outlive it.
+template <typename T, flat_forest_options Options = flat_forest_options{}>
+struct flat_forest_builder {
+  using value_type     = T;
+  using forest_type    = flat_forest<T, Options>;
+  using index_type     = typename forest_type::index_type;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  // Constructs an empty builder whose arena obtains memory from the default
+  // memory resource, starting with a block of `initial_arena_size` bytes.
+  explicit flat_forest_builder(size_t initial_arena_size = 4096)
+      : arena_(std::make_shared<std::pmr::monotonic_buffer_resource>(
+            initial_arena_size)) {}
+
+  flat_forest_builder(flat_forest_builder const &)            = delete;
+  flat_forest_builder &operator=(flat_forest_builder const &) = delete;
+  flat_forest_builder(flat_forest_builder &&)                 = default;
+
+  // Destroys the existing values before releasing the arena they may have
+  // allocated from.
+  flat_forest_builder &operator=(flat_forest_builder &&b) noexcept {
+    if (this == &b) { return *this; }
+    nodes_ = std::move(b.nodes_);
+    arena_ = std::move(b.arena_);
+    return *this;
+  }
+
+  // Returns an allocator drawing from the arena owned by this builder, with
+  // which values may allocate any memory they need.
+  allocator_type get_allocator() const { return allocator_type(arena_.get()); }
+
+  // Returns the number of nodes appended so far.
+  size_t size() const { return nodes_.size(); }
+
+  // Returns `true` if no nodes have been appended, and `false` otherwise.
+  bool empty() const { return nodes_.empty(); }
+
+  // Returns a reference to the value stored in the node referred to by
+  // `index`. References remain valid until the builder is finalized or
+  // destroyed.
+  value_type const &operator[](index_type index) const {
+    return nodes_[internal_flat_forest::access::position(index)].value;
+  }
+  value_type &operator[](index_type index) {
+    return nodes_[internal_flat_forest::access::position(index)].value;
+  }
+
+  // Appends a new leaf, constructed from `std::forward<Args>(args)...` and,
+  // if `value_type` uses `allocator_type`, the builder's allocator.
+  template <typename... Args>
+  index_type append_leaf(Args &&...args) requires
+      std::constructible_from<T, Args...> {
+    return append(1, std::forward<Args>(args)...);
+  }
+
+  // Appends a new node, as with `append_leaf`, which is an ancestor of all
+  // nodes appended after and including the node referred to by `index`. The
+  // requirements on `index` are the same as for
+  // `flat_forest::append_ancestor`.
+  template <typename... Args>
+  index_type append_ancestor(index_type index, Args &&...args) requires
+      std::constructible_from<T, Args...> {
+    size_t position = internal_flat_forest::access::position(index);
+    NTH_REQUIRE((debug), IsValidCutpoint(position));
+    return append(size() - position + 1, std::forward<Args>(args)...);
+  }
+
+  // Moves all appended nodes into a `flat_forest`, whose indices refer to the
+  // same nodes as those returned by this builder. The builder is left empty,
+  // and must not be used further other than to be destroyed or assigned to.
+  forest_type finalize() && {
+    forest_type forest;
+    internal_flat_forest::access::reserve(forest, nodes_.size());
+    for (auto &node : nodes_) {
+      internal_flat_forest::access::emplace_back(forest, node.subtree_size,
+                                                 std::move(node.value));
+    }
+    nodes_.clear();
+    internal_flat_forest::access::share_arena(forest, std::move(arena_));
+    return forest;
+  }
+
+ private:
+  template <typename... Args>
+  index_type append(size_t subtree_size, Args &&...args) {
+    size_t position = nodes_.size();
+    nodes_.emplace_back(subtree_size,
+                        std::uses_allocator_construction_args<T>(
+                            get_allocator(), std::forward<Args>(args)...));
+    return internal_flat_forest::access::make_index<index_type>(position);
+  }
+
+  [[maybe_unused]] bool IsValidCutpoint(size_t index) const {
+    size_t loc = size();
+    while (loc > index) { loc -= nodes_[loc - 1].subtree_size; }
+    return loc == index;
+  }
+
+  // Declared before `nodes_` so that it outlives the values.
+  std::shared_ptr<std::pmr::monotonic_buffer_resource> arena_;
+  internal_container::chunked_vector<internal_flat_forest::builder_node<T>>
+      nodes_;
+};
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_FLAT_FOREST_BUILDER_H
@@ -0,0 +1,135 @@
+#include "nth/container/flat_forest_builder.h"
+
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nth/container/flat_forest.h"
+#include "nth/debug/property/property.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("flat_forest_builder/default-construction") {
+  flat_forest_builder<std::string> b;
+  NTH_EXPECT(b.empty());
+  NTH_EXPECT(b.size() == 0u);
+
+  auto f = std::move(b).finalize();
+  NTH_EXPECT(f.empty());
+}
+
+NTH_TEST("flat_forest_builder/append") {
+  flat_forest_builder<std::string> b;
+  auto a = b.append_leaf("a");
+  b.append_leaf("b");
+  auto ab = b.append_ancestor(a, "ab");
+  auto c  = b.append_leaf("c");
+  NTH_EXPECT(b.size() == 4u);
+  NTH_EXPECT(b[ab] == "ab");
+  b[c] = "C";
+
+  auto f = std::move(b).finalize();
+  NTH_EXPECT(f.size() == 4u);
+  NTH_EXPECT(f[a] == "a");
+  NTH_EXPECT(f[ab] == "ab");
+  NTH_EXPECT(f[c] == "C");
+  NTH_EXPECT(f.roots() >>= debug::ElementsAreSequentially(std::string("C"),
+                                                          std::string("ab")));
+  NTH_EXPECT(f.entry(ab).children() >>= debug::ElementsAreSequentially(
+                 std::string("b"), std::string("a")));
+  NTH_EXPECT(f.build_structure().parent(a) == ab);
+}
+
+NTH_TEST("flat_forest_builder/separate-subtree-sizes") {
+  flat_forest_builder<std::string,
+                      flat_forest_options{.separate_subtree_sizes = true}>
+      b;
+  auto a = b.append_leaf("a");
+  b.append_leaf("b");
+  auto ab = b.append_ancestor(a, "ab");
+
+  auto f = std::move(b).finalize();
+  NTH_EXPECT(f.size() == 3u);
+  NTH_EXPECT(f.entry(ab).subtree_size() == 3u);
+  NTH_EXPECT(f.entry(ab).children() >>= debug::ElementsAreSequentially(
+                 std::string("b"), std::string("a")));
+}
+
+NTH_TEST("flat_forest_builder/arena") {
+  std::string long_string(100, 'x');
+  std::optional<flat_forest<std::pmr::string>> f;
+  std::pmr::memory_resource *arena;
+  std::vector<flat_forest<std::pmr::string>::index_type> indices;
+  {
+    flat_forest_builder<std::pmr::string> b(64);
+    arena = b.get_allocator().resource();
+    for (int i = 0; i < 100; ++i) {
+      indices.push_back(b.append_leaf(long_string + std::to_string(i)));
+    }
+    NTH_EXPECT(b[indices[0]].get_allocator().resource() == arena);
+    f = std::move(b).finalize();
+  }
+
+  // The arena outlives the builder, for as long as some forest refers to it.
+  NTH_EXPECT(f->size() == 100u);
+  NTH_EXPECT(std::string_view((*f)[indices[7]]) == long_string + "7");
+  NTH_EXPECT((*f)[indices[7]].get_allocator().resource() == arena);
+
+  flat_forest<std::pmr::string> copy = *f;
+  flat_forest<std::pmr::string> moved;
+  moved.append_leaf("replaced");
+  moved = std::move(*f);
+  f.reset();
+  NTH_EXPECT(std::string_view(moved[indices[42]]) == long_string + "42");
+  NTH_EXPECT(std::string_view(copy[indices[42]]) == long_string + "42");
+
+  copy  = moved;
+  moved = flat_forest<std::pmr::string>();
+  NTH_EXPECT(std::string_view(copy[indices[99]]) == long_string + "99");
+}
+
+// Appends a tree with eight children, each of which has eight leaf children,
+// in which every node holds a string too long to be stored inline.
+template <typename Forest>
+void AppendTree(Forest &f) {
+  std::optional<typename Forest::index_type> first;
+  for (int c = 0; c < 8; ++c) {
+    auto leaf = f.append_leaf("a leaf long enough to be heap allocated");
+    if (not first) { first = leaf; }
+    for (int l = 1; l < 8; ++l) {
+      f.append_leaf("a leaf long enough to be heap allocated");
+    }
+    f.append_ancestor(leaf, "a child long enough to be heap allocated");
+  }
+  f.append_ancestor(*first, "a root long enough to be heap allocated");
+}
+
+NTH_TEST("flat_forest_builder/benchmark/build", size_t tree_count) {
+  NTH_MEASURE() {
+    NTH_TIME("flat_forest") {
+      flat_forest<std::string> f;
+      for (size_t t = 0; t < tree_count; ++t) { AppendTree(f); }
+      nth::DoNotOptimize(f);
+    }
+    NTH_TIME("flat_forest_builder") {
+      flat_forest_builder<std::pmr::string> b;
+      for (size_t t = 0; t < tree_count; ++t) { AppendTree(b); }
+      auto f = std::move(b).finalize();
+      nth::DoNotOptimize(f);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("flat_forest_builder/benchmark/build") {
+  co_yield size_t{1} << 6;
+  co_yield size_t{1} << 12;
+}
+
+}  // namespace
+}  // namespace nth
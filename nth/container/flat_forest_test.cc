@@ -1,6 +1,13 @@
 #include "nth/container/flat_forest.h"
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "nth/debug/property/property.h"
+#include "nth/test/benchmark.h"
 #include "nth/test/test.h"
 
 namespace nth {
@@ -19,7 +26,10 @@ NTH_TEST("flat_forest/append_leaf") {
   NTH_EXPECT(f.size() == 1u);
   NTH_EXPECT(f[index] == "leaf");
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
   NTH_EXPECT(not cf.empty());
   NTH_EXPECT(cf.size() == 1u);
   NTH_EXPECT(cf[index] == "leaf");
@@ -32,7 +42,10 @@ NTH_TEST("flat_forest/append_leaf") {
   NTH_EXPECT(f.size() == 1u);
   NTH_EXPECT(f[index] == "leaf");
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
   NTH_EXPECT(not cf.empty());
   NTH_EXPECT(cf.size() == 1u);
   NTH_EXPECT(cf[index] == "leaf");
@@ -52,7 +65,10 @@ NTH_TEST("flat_forest/append_ancestor") {
   NTH_EXPECT(f[c] == "c");
   NTH_EXPECT(f[bc] == "bc");
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
   NTH_EXPECT(not cf.empty());
   NTH_EXPECT(cf.size() == 4u);
   NTH_EXPECT(cf[a] == "a");
@@ -78,7 +94,10 @@ NTH_TEST("flat_forest/entry/operator*") {
   NTH_EXPECT(*f.centry(c) == "c");
   NTH_EXPECT(*f.centry(bc) == "bc");
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
 
   NTH_EXPECT(*cf.entry(a) == "a");
   NTH_EXPECT(*cf.entry(b) == "b");
@@ -113,7 +132,10 @@ NTH_TEST("flat_forest/entry/subtree") {
   NTH_EXPECT(f.centry(c).subtree_size() == 1u);
   NTH_EXPECT(f.centry(bc).subtree_size() == 3u);
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
 
   NTH_EXPECT(cf.entry(a).subtree(post_order).size() == 1u);
   NTH_EXPECT(cf.entry(b).subtree(post_order).size() == 1u);
@@ -143,7 +165,10 @@ NTH_TEST("flat_forest/entry/descendants") {
   NTH_EXPECT(f.centry(c).descendants(post_order).size() == 0u);
   NTH_EXPECT(f.centry(bc).descendants(post_order).size() == 2u);
 
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
   flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
 
   NTH_EXPECT(cf.entry(a).descendants(post_order).size() == 0u);
   NTH_EXPECT(cf.entry(b).descendants(post_order).size() == 0u);
@@ -219,5 +244,198 @@ NTH_TEST("flat_forest/roots/iteration/empty") {
   NTH_EXPECT(f.roots() >>= debug::ElementsAreSequentially());
 }
 
+template <typename R>
+std::vector<std::string> Values(flat_forest<std::string> const &f, R &&r) {
+  std::vector<std::string> values;
+  for (auto index : r) { values.push_back(f[index]); }
+  return values;
+}
+
+NTH_TEST("flat_forest/structure/parent") {
+  flat_forest<std::string> f;
+  auto a    = f.append_leaf("a");
+  auto b    = f.append_leaf("b");
+  auto ab   = f.append_ancestor(a, "ab");
+  auto c    = f.append_leaf("c");
+  auto d    = f.append_leaf("d");
+  auto cd   = f.append_ancestor(c, "cd");
+  auto abcd = f.append_ancestor(a, "abcd");
+  auto e    = f.append_leaf("e");
+
+  NTH_EXPECT(not f.has_structure());
+  auto const &s = f.build_structure();
+  NTH_EXPECT(f.has_structure());
+  NTH_EXPECT(s.parent(a) == ab);
+  NTH_EXPECT(s.parent(b) == ab);
+  NTH_EXPECT(s.parent(ab) == abcd);
+  NTH_EXPECT(s.parent(d) == cd);
+  NTH_EXPECT(s.parent(cd) == abcd);
+  NTH_EXPECT(s.parent(abcd) == std::nullopt);
+  NTH_EXPECT(s.parent(e) == std::nullopt);
+
+  NTH_EXPECT(s.depth(abcd) == 0u);
+  NTH_EXPECT(s.depth(e) == 0u);
+  NTH_EXPECT(s.depth(cd) == 1u);
+  NTH_EXPECT(s.depth(c) == 2u);
+
+  NTH_EXPECT(s.first_child(abcd) == ab);
+  NTH_EXPECT(s.first_child(cd) == c);
+  NTH_EXPECT(s.first_child(a) == std::nullopt);
+  NTH_EXPECT(s.first_child(e) == std::nullopt);
+
+  // Appending invalidates the index, which must then be rebuilt.
+  auto root = f.append_ancestor(a, "root");
+  NTH_EXPECT(not f.has_structure());
+  f.build_structure();
+  NTH_EXPECT(f.structure().parent(abcd) == root);
+  NTH_EXPECT(f.structure().parent(e) == root);
+  NTH_EXPECT(f.structure().depth(c) == 3u);
+}
+
+NTH_TEST("flat_forest/structure/traversal") {
+  flat_forest<std::string> f;
+  auto a = f.append_leaf("a");
+  f.append_leaf("b");
+  f.append_ancestor(a, "ab");
+  auto c = f.append_leaf("c");
+  f.append_leaf("d");
+  f.append_ancestor(c, "cd");
+  f.append_ancestor(a, "abcd");
+  f.append_leaf("e");
+
+  // Copying a forest copies any index already built for it.
+  f.build_structure();
+  flat_forest<std::string> const cf = f;
+  NTH_ASSERT(cf.has_structure());
+  NTH_EXPECT(Values(cf, cf.structure().nodes(pre_order)) >>=
+             debug::ElementsAreSequentially(
+                 std::string("abcd"), std::string("ab"), std::string("a"),
+                 std::string("b"), std::string("cd"), std::string("c"),
+                 std::string("d"), std::string("e")));
+  NTH_EXPECT(Values(cf, cf.structure().nodes(level_order)) >>=
+             debug::ElementsAreSequentially(
+                 std::string("abcd"), std::string("e"), std::string("ab"),
+                 std::string("cd"), std::string("a"), std::string("b"),
+                 std::string("c"), std::string("d")));
+}
+
+NTH_TEST("flat_forest/structure/empty") {
+  flat_forest<std::string> f;
+  f.build_structure();
+  NTH_EXPECT(Values(f, f.structure().nodes(pre_order)) >>=
+             debug::ElementsAreSequentially());
+  NTH_EXPECT(Values(f, f.structure().nodes(level_order)) >>=
+             debug::ElementsAreSequentially());
+}
+
+NTH_TEST("flat_forest/separate-subtree-sizes") {
+  flat_forest<std::string, flat_forest_options{.separate_subtree_sizes = true}>
+      f;
+  auto a = f.append_leaf("a");
+  f.append_leaf("b");
+  f.append_ancestor(a, "ab");
+  auto c = f.append_leaf("c");
+  f.append_leaf("d");
+  auto cd   = f.append_ancestor(c, "cd");
+  auto abcd = f.append_ancestor(a, "abcd");
+  f.append_leaf("e");
+
+  NTH_EXPECT(f.size() == 8u);
+  NTH_EXPECT(f[cd] == "cd");
+  NTH_EXPECT(f.entry(abcd).subtree_size() == 7u);
+  NTH_EXPECT(f.roots() >>= debug::ElementsAreSequentially(std::string("e"),
+                                                          std::string("abcd")));
+  NTH_EXPECT(f.entry(abcd).children() >>= debug::ElementsAreSequentially(
+                 std::string("cd"), std::string("ab")));
+  NTH_EXPECT(f.centry(cd).subtree(post_order) >>=
+             debug::ElementsAreSequentially(std::string("c"), std::string("d"),
+                                            std::string("cd")));
+  NTH_EXPECT(f.build_structure().parent(c) == cd);
+
+  *f.entry(c) = "C";
+  NTH_EXPECT(f[c] == "C");
+}
+
+// A payload large enough that iterating over the values of a forest costs
+// considerably more than iterating over its shape.
+struct fat_payload {
+  explicit fat_payload(uint64_t n) { data.fill(n); }
+  std::array<uint64_t, 16> data;
+};
+
+// Returns a forest with `root_count` roots, each of which has eight children
+// with eight leaf children of their own.
+template <flat_forest_options Options>
+flat_forest<fat_payload, Options> MakeForest(size_t root_count) {
+  flat_forest<fat_payload, Options> f;
+  uint64_t n = 0;
+  for (size_t r = 0; r < root_count; ++r) {
+    std::optional<typename flat_forest<fat_payload, Options>::index_type> first;
+    for (size_t c = 0; c < 8; ++c) {
+      auto leaf = f.append_leaf(n++);
+      if (not first) { first = leaf; }
+      for (size_t l = 1; l < 8; ++l) { f.append_leaf(n++); }
+      f.append_ancestor(leaf, n++);
+    }
+    f.append_ancestor(*first, n++);
+  }
+  return f;
+}
+
+template <flat_forest_options Options>
+uint64_t CountRootsAndChildren(flat_forest<fat_payload, Options> const &f) {
+  uint64_t count = 0;
+  auto roots     = f.roots();
+  for (auto root = roots.begin(); root != roots.end(); ++root) {
+    for (auto child = root.children().begin(); child != root.children().end();
+         ++child) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+template <flat_forest_options Options>
+uint64_t SumDescendants(flat_forest<fat_payload, Options> const &f) {
+  uint64_t sum = 0;
+  auto roots   = f.roots();
+  for (auto root = roots.begin(); root != roots.end(); ++root) {
+    for (auto const &value : root.descendants(post_order)) {
+      sum += value.data[0];
+    }
+  }
+  return sum;
+}
+
+NTH_TEST("flat_forest/benchmark/layout", size_t root_count) {
+  constexpr flat_forest_options Packed;
+  constexpr flat_forest_options Separate{.separate_subtree_sizes = true};
+  auto packed   = MakeForest<Packed>(root_count);
+  auto separate = MakeForest<Separate>(root_count);
+  NTH_MEASURE() {
+    NTH_TIME("packed/children") {
+      uint64_t count = CountRootsAndChildren(packed);
+      nth::DoNotOptimize(count);
+    }
+    NTH_TIME("separate/children") {
+      uint64_t count = CountRootsAndChildren(separate);
+      nth::DoNotOptimize(count);
+    }
+    NTH_TIME("packed/descendants") {
+      uint64_t sum = SumDescendants(packed);
+      nth::DoNotOptimize(sum);
+    }
+    NTH_TIME("separate/descendants") {
+      uint64_t sum = SumDescendants(separate);
+      nth::DoNotOptimize(sum);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("flat_forest/benchmark/layout") {
+  co_yield size_t{1} << 8;
+  co_yield size_t{1} << 14;
+}
+
 }  // namespace
 }  // namespace nth
@@ -2,11 +2,14 @@
 #define NTH_CONTAINER_FLYWEIGHT_MAP_H
 
 #include <concepts>
-#include <deque>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <ranges>
 #include <utility>
 
 #include "absl/container/flat_hash_set.h"
+#include "nth/container/internal/chunked_vector.h"
 #include "nth/container/internal/index.h"
 #include "nth/debug/debug.h"
 #include "nth/meta/concepts/hash.h"
@@ -27,14 +30,17 @@ struct flyweight_map {
   using hasher      = Hash;
   using key_equal   = Eq;
 
-  using iterator       = typename std::deque<value_type>::iterator;
-  using const_iterator = typename std::deque<value_type>::const_iterator;
-  using reverse_iterator =
-      typename std::deque<value_type>::const_reverse_iterator;
+ private:
+  using storage_type = internal_container::chunked_vector<value_type>;
+
+ public:
+  using iterator               = typename storage_type::iterator;
+  using const_iterator         = typename storage_type::const_iterator;
+  using reverse_iterator       = typename storage_type::const_reverse_iterator;
   using const_reverse_iterator = reverse_iterator;
 
-  using reference       = typename std::deque<value_type>::reference;
-  using const_reference = typename std::deque<value_type>::const_reference;
+  using reference       = typename storage_type::reference;
+  using const_reference = typename storage_type::const_reference;
   using pointer         = value_type*;
   using const_pointer   = value_type const*;
 
@@ -56,16 +62,24 @@ struct flyweight_map {
 
   template <std::input_iterator Iter>
   flyweight_map(Iter b, Iter e) : set_(0, H(&values_), E(&values_)) {
-    for (auto i = b; i < e; ++i) { try_emplace(i->first, i->second); }
+    insert(b, e);
   }
 
-  flyweight_map(flyweight_map const& f) : flyweight_map(f.begin(), f.end()) {}
+  // Copies are made by copying the stored values wholesale and then building
+  // the index from the entries of `f.set_`, in a table created at its final
+  // bucket count so that it never grows during the copy. Entries are compared
+  // by position alone, so no key is ever compared, though each key is hashed
+  // once.
+  flyweight_map(flyweight_map const& f)
+      : values_(f.values_),
+        set_(f.set_.begin(), f.set_.end(), f.set_.bucket_count(), H(&values_),
+             E(&values_)) {}
   flyweight_map& operator=(flyweight_map const& f) {
-    values_.clear();
-    set_.clear();
-    for (auto i = f.begin(); i < f.end(); ++i) {
-      try_emplace(i->first, i->second);
-    }
+    if (this == &f) { return *this; }
+    values_ = f.values_;
+    set_    = absl::flat_hash_set<internal_container::Index, H, E>(
+        f.set_.begin(), f.set_.end(), f.set_.bucket_count(), H(&values_),
+        E(&values_));
     return *this;
   }
 
@@ -86,6 +100,13 @@ struct flyweight_map {
     set_.clear();
   }
 
+  // Ensures that at least `n` elements can be held in total without
+  // reallocating either the value storage or the index.
+  void reserve(size_type n) {
+    values_.reserve(n);
+    set_.reserve(n);
+  }
+
   // Iterators traverse elements in the order they were inserted.
   iterator begin() { return values_.begin(); }
   iterator end() { return values_.end(); }
@@ -144,6 +165,28 @@ struct flyweight_map {
     }
   }
 
+  // Inserts each key-value pair in the range `[b, e)` whose key is not
+  // equivalent to one already in the container (or earlier in the range), in
+  // order, as if by `try_emplace`. If the length of the range can be computed
+  // up front, the container is first reserved so that it grows at most once.
+  template <std::input_iterator Iter>
+  void insert(Iter b, Iter e) {
+    if constexpr (std::forward_iterator<Iter>) {
+      reserve(size() + static_cast<size_type>(std::distance(b, e)));
+    }
+    for (; b != e; ++b) { try_emplace(b->first, b->second); }
+  }
+
+  // Inserts each key-value pair of `r` as if by
+  // `insert(std::ranges::begin(r), std::ranges::end(r))`.
+  template <std::ranges::input_range R>
+  void insert_range(R&& r) {
+    if constexpr (std::ranges::sized_range<R>) {
+      reserve(size() + static_cast<size_type>(std::ranges::size(r)));
+    }
+    for (auto const& [k, m] : r) { try_emplace(k, m); }
+  }
+
   // Returns a pointer to an element in the container equivalent to the object
   // referenced by `t` if one exists, or a null pointer otherwise.
   template <std::convertible_to<K> T>
@@ -188,7 +231,7 @@ struct flyweight_map {
 
  private:
   struct H : private hasher {
-    explicit H(std::deque<value_type> const* values) : values_(values) {}
+    explicit H(storage_type const* values) : values_(values) {}
 
     using is_transparent = void;
 
@@ -199,18 +242,19 @@ struct flyweight_map {
     }
 
    private:
-    std::deque<value_type> const* values_;
+    storage_type const* values_;
   };
 
   struct E : private key_equal {
-    explicit E(std::deque<value_type> const* values) : values_(values) {}
+    explicit E(storage_type const* values) : values_(values) {}
 
     using is_transparent = void;
 
+    // Entries in the index always refer to distinct keys, so two entries are
+    // equivalent exactly when they refer to the same position.
     bool operator()(internal_container::Index lhs,
                     internal_container::Index rhs) const {
-      return key_equal::operator()((*values_)[lhs.value].first,
-                                   (*values_)[rhs.value].first);
+      return lhs.value == rhs.value;
     }
 
     bool operator()(internal_container::Index lhs, auto const& rhs) const
@@ -232,10 +276,10 @@ struct flyweight_map {
     }
 
    private:
-    std::deque<value_type> const* values_;
+    storage_type const* values_;
   };
 
-  std::deque<value_type> values_;
+  storage_type values_;
   absl::flat_hash_set<internal_container::Index, H, E> set_;
 };
 
@@ -1,5 +1,10 @@
 #include "nth/container/flyweight_map.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nth/test/benchmark.h"
 #include "nth/test/test.h"
 
 namespace nth {
@@ -246,5 +251,63 @@ NTH_TEST("flyweight_map/stress-test") {
   }
 }
 
+NTH_TEST("flyweight_map/insert-range") {
+  flyweight_map<int, std::string> f{{1, "a"}};
+  std::vector<std::pair<int, std::string>> v{{2, "b"}, {1, "x"}, {3, "c"}};
+  f.insert(v.begin(), v.end());
+  NTH_EXPECT(f.size() == size_t{3});
+  NTH_EXPECT(f.find(1)->second == "a");
+  NTH_EXPECT(f.index(3) == size_t{2});
+
+  f.insert_range(std::vector<std::pair<int, std::string>>{{4, "d"}, {2, "y"}});
+  NTH_EXPECT(f.size() == size_t{4});
+  NTH_EXPECT(f.find(2)->second == "b");
+  NTH_EXPECT(f.from_index(3).second == "d");
+}
+
+NTH_TEST("flyweight_map/copy") {
+  flyweight_map<int, std::string> f{{1, "a"}, {2, "b"}};
+  flyweight_map<int, std::string> g = f;
+  f[3]              = "c";
+  g.find(1)->second = "x";
+  NTH_EXPECT(g.size() == size_t{2});
+  NTH_EXPECT(g.index(3) == g.end_index());
+  NTH_EXPECT(f.find(1)->second == "a");
+
+  g = f;
+  NTH_EXPECT(g.size() == size_t{3});
+  NTH_EXPECT(g.index(3) == size_t{2});
+  NTH_EXPECT(g.find(1)->second == "a");
+}
+
+NTH_TEST("flyweight_map/benchmark/insert") {
+  NTH_MEASURE() {
+    flyweight_map<size_t, size_t> f;
+    NTH_TIME("try_emplace") {
+      for (size_t i = 0; i < 1024; ++i) { f.try_emplace(i, i); }
+      nth::DoNotOptimize(f);
+    }
+  }
+}
+
+NTH_TEST("flyweight_map/benchmark/lookup") {
+  flyweight_map<size_t, size_t> f;
+  for (size_t i = 0; i < 1024; ++i) { f.try_emplace(i * 7919, i); }
+  NTH_MEASURE() {
+    NTH_TIME("find") {
+      for (size_t i = 0; i < 1024; ++i) { nth::DoNotOptimize(f.find(i)); }
+    }
+    NTH_TIME("index") {
+      for (size_t i = 0; i < 1024; ++i) { nth::DoNotOptimize(f.index(i)); }
+    }
+    NTH_TIME("from_index") {
+      for (size_t i = 0; i < 1024; ++i) {
+        size_t value = f.from_index(i).second;
+        nth::DoNotOptimize(value);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace nth
@@ -2,36 +2,61 @@
 #define NTH_CONTAINER_FLYWEIGHT_SET_H
 
 #include <concepts>
-#include <deque>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <type_traits>
 #include <utility>
 
 #include "absl/container/flat_hash_set.h"
+#include "nth/container/internal/chunked_vector.h"
 #include "nth/container/internal/index.h"
 #include "nth/debug/debug.h"
 #include "nth/meta/concepts/hash.h"
 
 namespace nth {
+
+struct flyweight_set_options {
+  // When set, the hash of each element is computed once, upon insertion, and
+  // stored in the index alongside the element's position. Growing the index
+  // then never rehashes elements, and lookups only compare against elements
+  // whose hash matches exactly. This costs an additional `size_t` per slot in
+  // the index and is worthwhile when elements are expensive to hash or
+  // compare (e.g., long strings). Copying a set with cached hashes does not
+  // read its elements other than to copy them.
+  bool cache_hashes = false;
+};
+
 // `flyweight_set<V>` is an ordered container, where the keys are guaranteed to
 // be distinct. Pointers to elements in the container are never invalidated
 // other than by assignment or calls to `clear`. Iteration occurs in the order
 // the elements are inserted.
 template <typename V, nth::hasher<V> Hash = absl::Hash<V>,
-          std::equivalence_relation<V, V> Eq = std::equal_to<V>>
+          std::equivalence_relation<V, V> Eq = std::equal_to<V>,
+          flyweight_set_options Options = flyweight_set_options{}>
 struct flyweight_set {
   using value_type = V;
   using size_type  = size_t;
   using hasher     = Hash;
   using key_equal  = Eq;
 
-  using iterator       = typename std::deque<value_type>::const_iterator;
-  using const_iterator = typename std::deque<value_type>::const_iterator;
-  using reverse_iterator =
-      typename std::deque<value_type>::const_reverse_iterator;
+  static constexpr flyweight_set_options options = Options;
+
+ private:
+  using storage_type = internal_container::chunked_vector<value_type>;
+  using index_type =
+      std::conditional_t<Options.cache_hashes, internal_container::HashedIndex,
+                         internal_container::Index>;
+
+ public:
+  using iterator               = typename storage_type::const_iterator;
+  using const_iterator         = typename storage_type::const_iterator;
+  using reverse_iterator       = typename storage_type::const_reverse_iterator;
   using const_reverse_iterator = reverse_iterator;
 
-  using reference       = typename std::deque<value_type>::reference;
-  using const_reference = typename std::deque<value_type>::const_reference;
+  using reference       = typename storage_type::reference;
+  using const_reference = typename storage_type::const_reference;
   using pointer         = value_type const*;
   using const_pointer   = value_type const*;
 
@@ -44,7 +69,7 @@ struct flyweight_set {
 
   flyweight_set& operator=(flyweight_set&& s) {
     values_ = std::move(s.values_);
-    set_    = absl::flat_hash_set<internal_container::Index, H, E>(
+    set_    = absl::flat_hash_set<index_type, H, E>(
         std::make_move_iterator(s.set_.begin()),
         std::make_move_iterator(s.set_.end()), s.set_.bucket_count(),
         H(&values_), E(&values_));
@@ -53,14 +78,25 @@ struct flyweight_set {
 
   template <std::input_iterator Iter>
   flyweight_set(Iter b, Iter e) : set_(0, H(&values_), E(&values_)) {
-    for (auto i = b; i < e; ++i) { insert(*i); }
+    insert(b, e);
   }
 
-  flyweight_set(flyweight_set const& f) : flyweight_set(f.begin(), f.end()) {}
+  // Copies are made by copying the stored values wholesale and then building
+  // the index from the entries of `f.set_`, in a table created at its final
+  // bucket count so that it never grows during the copy. Entries are compared
+  // by position alone, so no element is ever compared. When hashes are cached,
+  // entries are hashed without reading their elements either, so the copy
+  // never touches the elements. Otherwise each element is hashed once.
+  flyweight_set(flyweight_set const& f)
+      : values_(f.values_),
+        set_(f.set_.begin(), f.set_.end(), f.set_.bucket_count(), H(&values_),
+             E(&values_)) {}
   flyweight_set& operator=(flyweight_set const& f) {
-    values_.clear();
-    set_.clear();
-    for (auto i = f.begin(); i < f.end(); ++i) { insert(*i); }
+    if (this == &f) { return *this; }
+    values_ = f.values_;
+    set_    = absl::flat_hash_set<index_type, H, E>(
+        f.set_.begin(), f.set_.end(), f.set_.bucket_count(), H(&values_),
+        E(&values_));
     return *this;
   }
 
@@ -75,6 +111,13 @@ struct flyweight_set {
     set_.clear();
   }
 
+  // Ensures that at least `n` elements can be held in total without
+  // reallocating either the value storage or the index.
+  void reserve(size_type n) {
+    values_.reserve(n);
+    set_.reserve(n);
+  }
+
   // Iterators traverse elements in the order they were inserted.
   iterator begin() { return values_.begin(); }
   iterator end() { return values_.end(); }
@@ -117,11 +160,12 @@ struct flyweight_set {
   // key equivalent to the value referenced `v` before `insert` was called, and
   // a boolean indicating whether an insertion actually took place.
   std::pair<iterator, bool> insert(value_type const& v) {
-    if (auto iter = set_.find(v); iter != set_.end()) {
+    decltype(auto) key = lookup_key(v);
+    if (auto iter = set_.find(key); iter != set_.end()) {
       return std::pair<iterator, bool>(begin() + iter->value, false);
     } else {
       values_.push_back(v);
-      iter = set_.insert({.value = values_.size() - 1}).first;
+      iter = set_.insert(make_index(values_.size() - 1, key)).first;
       return std::pair<iterator, bool>(begin() + iter->value, true);
     }
   }
@@ -135,20 +179,43 @@ struct flyweight_set {
   // before `insert` was called, and a boolean indicating whether an insertion
   // actually took place.
   std::pair<iterator, bool> insert(value_type&& v) {
-    if (auto iter = set_.find(v); iter != set_.end()) {
+    decltype(auto) key = lookup_key(v);
+    if (auto iter = set_.find(key); iter != set_.end()) {
       return std::pair<iterator, bool>(begin() + iter->value, false);
     } else {
       values_.push_back(std::move(v));
-      iter = set_.insert({.value = values_.size() - 1}).first;
+      iter = set_.insert(make_index(values_.size() - 1, key)).first;
       return std::pair<iterator, bool>(begin() + iter->value, true);
     }
   }
 
+  // Inserts each element in the range `[b, e)` which is not equivalent to an
+  // element already in the container (or earlier in the range), in order. If
+  // the length of the range can be computed up front, the container is first
+  // reserved so that it grows at most once.
+  template <std::input_iterator Iter>
+  void insert(Iter b, Iter e) {
+    if constexpr (std::forward_iterator<Iter>) {
+      reserve(size() + static_cast<size_type>(std::distance(b, e)));
+    }
+    for (; b != e; ++b) { insert(*b); }
+  }
+
+  // Inserts each element of `r` as if by `insert(std::ranges::begin(r),
+  // std::ranges::end(r))`.
+  template <std::ranges::input_range R>
+  void insert_range(R&& r) {
+    if constexpr (std::ranges::sized_range<R>) {
+      reserve(size() + static_cast<size_type>(std::ranges::size(r)));
+    }
+    for (auto&& v : r) { insert(std::forward<decltype(v)>(v)); }
+  }
+
   // Returns a pointer to an element in the container equivalent to the object
   // referenced by `t` if one exists, or a null pointer otherwise.
   template <std::convertible_to<value_type> T>
   const_iterator find(T const& t) const requires(nth::hasher<hasher, T>) {
-    auto iter = set_.find(t);
+    auto iter = set_.find(lookup_key(t));
     return iter != set_.end() ? begin() + iter->value : cend();
   }
 
@@ -158,7 +225,7 @@ struct flyweight_set {
   // Returns the index of an element equivalent if it is in the container. If
   // not present, returns `end_index()`
   size_t index(value_type const& v) const {
-    auto iter = set_.find(v);
+    auto iter = set_.find(lookup_key(v));
     return iter == set_.end() ? end_index() : iter->value;
   }
 
@@ -175,8 +242,28 @@ struct flyweight_set {
   size_t end_index() const { return std::numeric_limits<size_t>::max(); }
 
  private:
+  // Returns the key with which `t` should be looked up in `set_`: `t` itself,
+  // or `t` along with its hash when hashes are cached.
+  template <typename T>
+  decltype(auto) lookup_key(T const& t) const {
+    if constexpr (Options.cache_hashes) {
+      return internal_container::HashedKey<T>{.value = t,
+                                              .hash  = set_.hash_function()(t)};
+    } else {
+      return (t);
+    }
+  }
+
+  static index_type make_index(size_t n, auto const& key) {
+    if constexpr (Options.cache_hashes) {
+      return {.value = n, .hash = key.hash};
+    } else {
+      return {.value = n};
+    }
+  }
+
   struct H : private hasher {
-    explicit H(std::deque<value_type> const* values) : values_(values) {}
+    explicit H(storage_type const* values) : values_(values) {}
 
     using is_transparent = void;
 
@@ -187,12 +274,21 @@ struct flyweight_set {
       return operator()((*values_)[p.value]);
     }
 
+    size_t operator()(internal_container::HashedIndex p) const {
+      return p.hash;
+    }
+
+    template <typename T>
+    size_t operator()(internal_container::HashedKey<T> const& k) const {
+      return k.hash;
+    }
+
    private:
-    std::deque<value_type> const* values_;
+    storage_type const* values_;
   };
 
   struct E : private key_equal {
-    explicit E(std::deque<value_type> const* values) : values_(values) {}
+    explicit E(storage_type const* values) : values_(values) {}
 
     using is_transparent = void;
 
@@ -214,18 +310,42 @@ struct flyweight_set {
       return key_equal::operator()(lhs, (*values_)[rhs.value]);
     }
 
+    // Entries in the index always refer to distinct elements, so two entries
+    // are equivalent exactly when they refer to the same position.
     bool operator()(internal_container::Index lhs,
                     internal_container::Index rhs) const {
-      return key_equal::operator()((*values_)[lhs.value],
-                                   (*values_)[rhs.value]);
+      return lhs.value == rhs.value;
+    }
+
+    template <typename T>
+    bool operator()(internal_container::HashedIndex lhs,
+                    internal_container::HashedKey<T> const& rhs) const
+        requires(std::equivalence_relation<key_equal, value_type const&,
+                                           T const&>) {
+      return lhs.hash == rhs.hash and
+             key_equal::operator()((*values_)[lhs.value], rhs.value);
+    }
+
+    template <typename T>
+    bool operator()(internal_container::HashedKey<T> const& lhs,
+                    internal_container::HashedIndex rhs) const
+        requires(std::equivalence_relation<key_equal, T const&,
+                                           value_type const&>) {
+      return lhs.hash == rhs.hash and
+             key_equal::operator()(lhs.value, (*values_)[rhs.value]);
+    }
+
+    bool operator()(internal_container::HashedIndex lhs,
+                    internal_container::HashedIndex rhs) const {
+      return lhs.value == rhs.value;
     }
 
    private:
-    std::deque<value_type> const* values_;
+    storage_type const* values_;
   };
 
-  std::deque<value_type> values_;
-  absl::flat_hash_set<internal_container::Index, H, E> set_;
+  storage_type values_;
+  absl::flat_hash_set<index_type, H, E> set_;
 };
 
 }  // namespace nth
@@ -1,5 +1,10 @@
 #include "nth/container/flyweight_set.h"
 
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "nth/test/benchmark.h"
 #include "nth/test/test.h"
 
 namespace nth {
@@ -165,5 +170,188 @@ NTH_TEST("flyweight_set/from-index") {
   NTH_EXPECT(f.from_index(3) == "d");
 }
 
+NTH_TEST("flyweight_set/insert-range") {
+  flyweight_set<std::string> f{"a"};
+  std::vector<std::string> v{"b", "a", "c", "b", "d"};
+  f.insert(v.begin(), v.end());
+  NTH_EXPECT(f >>= ElementsAreSequentially(std::string("a"), std::string("b"),
+                                           std::string("c"), std::string("d")));
+
+  f.insert_range(std::vector<std::string>{"e", "d", "f"});
+  NTH_EXPECT(f >>= ElementsAreSequentially(std::string("a"), std::string("b"),
+                                           std::string("c"), std::string("d"),
+                                           std::string("e"), std::string("f")));
+}
+
+NTH_TEST("flyweight_set/reserve") {
+  flyweight_set<size_t> f;
+  f.reserve(100);
+  std::vector<size_t const*> pointers;
+  for (size_t i = 0; i < 100; ++i) { pointers.push_back(&*f.insert(i).first); }
+  for (size_t i = 0; i < 100; ++i) {
+    NTH_EXPECT(&f.from_index(i) == pointers[i]);
+  }
+}
+
+NTH_TEST("flyweight_set/copy") {
+  flyweight_set<std::string> f{"a", "b", "c"};
+  flyweight_set<std::string> g = f;
+  f.insert("d");
+  NTH_EXPECT(g >>= ElementsAreSequentially(std::string("a"), std::string("b"),
+                                           std::string("c")));
+  NTH_EXPECT(g.index("c") == size_t{2});
+  NTH_EXPECT(g.index("d") == g.end_index());
+  NTH_EXPECT(g.insert("d").second);
+
+  g = f;
+  NTH_EXPECT(g >>= ElementsAreSequentially(std::string("a"), std::string("b"),
+                                           std::string("c"), std::string("d")));
+  NTH_EXPECT(g.index("d") == size_t{3});
+}
+
+struct CountingHash {
+  size_t operator()(std::string const& s) const {
+    ++count;
+    return std::hash<std::string>{}(s);
+  }
+  static inline int count = 0;
+};
+
+NTH_TEST("flyweight_set/cached-hash") {
+  flyweight_set<std::string, CountingHash, std::equal_to<std::string>,
+                {.cache_hashes = true}>
+      f;
+  CountingHash::count = 0;
+  for (int i = 0; i < 1000; ++i) { f.insert(std::to_string(i)); }
+  NTH_EXPECT(f.size() == size_t{1000});
+  // Each element is hashed once, when it is inserted, regardless of how many
+  // times the index grows.
+  NTH_EXPECT(CountingHash::count == 1000);
+
+  NTH_EXPECT(f.index("17") == size_t{17});
+  NTH_EXPECT(f.index("x") == f.end_index());
+  NTH_EXPECT(f.find("999") == std::prev(f.end()));
+  NTH_EXPECT(not f.insert("5").second);
+  NTH_EXPECT(CountingHash::count == 1004);
+
+  auto g = std::move(f);
+  NTH_EXPECT(g.index("17") == size_t{17});
+  NTH_EXPECT(CountingHash::count == 1005);
+}
+
+// A deliberately poor hash, under which many elements collide.
+struct CountingLengthHash {
+  size_t operator()(std::string const& s) const {
+    ++count;
+    return s.size();
+  }
+  static inline int count = 0;
+};
+
+struct CountingEq {
+  bool operator()(std::string const& l, std::string const& r) const {
+    ++count;
+    return l == r;
+  }
+  static inline int count = 0;
+};
+
+NTH_TEST("flyweight_set/cached-hash/copy") {
+  flyweight_set<std::string, CountingLengthHash, CountingEq,
+                {.cache_hashes = true}>
+      f;
+  for (int i = 0; i < 1000; ++i) { f.insert(std::to_string(i)); }
+  CountingLengthHash::count = 0;
+  CountingEq::count         = 0;
+
+  // Copies reuse the cached hashes and never compare elements, even though
+  // their hashes collide.
+  auto g = f;
+  g      = f;
+  NTH_EXPECT(CountingLengthHash::count == 0);
+  NTH_EXPECT(CountingEq::count == 0);
+
+  NTH_EXPECT(g.size() == size_t{1000});
+  NTH_EXPECT(g.index("17") == size_t{17});
+  NTH_EXPECT(&g.from_index(17) != &f.from_index(17));
+  NTH_EXPECT(g.insert("1000").second);
+  NTH_EXPECT(not g.insert("999").second);
+  NTH_EXPECT(f.index("1000") == f.end_index());
+}
+
+NTH_TEST("flyweight_set/benchmark/cached-hash", auto cache_hashes) {
+  std::vector<std::string> strings;
+  for (int i = 0; i < 1024; ++i) {
+    strings.push_back(std::string(256, 'x') + std::to_string(i));
+  }
+  NTH_MEASURE() {
+    flyweight_set<std::string, absl::Hash<std::string>,
+                  std::equal_to<std::string>,
+                  {.cache_hashes = nth::type_t<cache_hashes>::value}>
+        f;
+    NTH_TIME("insert") {
+      for (auto const& s : strings) { f.insert(s); }
+      nth::DoNotOptimize(f);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("flyweight_set/benchmark/cached-hash") {
+  co_yield nth::type<std::false_type>;
+  co_yield nth::type<std::true_type>;
+}
+
+NTH_TEST("flyweight_set/benchmark/insert") {
+  NTH_MEASURE() {
+    flyweight_set<size_t> f;
+    NTH_TIME("insert") {
+      for (size_t i = 0; i < 1024; ++i) { f.insert(i); }
+      nth::DoNotOptimize(f);
+    }
+  }
+}
+
+NTH_TEST("flyweight_set/benchmark/bulk-build") {
+  std::vector<std::string> strings;
+  for (int i = 0; i < 4096; ++i) {
+    strings.push_back("symbol_" + std::to_string(i % 3072));
+  }
+  flyweight_set<std::string> original(strings.begin(), strings.end());
+  NTH_MEASURE() {
+    NTH_TIME("one-at-a-time") {
+      flyweight_set<std::string> f;
+      for (auto const& s : strings) { f.insert(s); }
+      nth::DoNotOptimize(f);
+    }
+    NTH_TIME("range-construction") {
+      flyweight_set<std::string> f(strings.begin(), strings.end());
+      nth::DoNotOptimize(f);
+    }
+    NTH_TIME("copy") {
+      flyweight_set<std::string> f = original;
+      nth::DoNotOptimize(f);
+    }
+  }
+}
+
+NTH_TEST("flyweight_set/benchmark/lookup") {
+  flyweight_set<size_t> f;
+  for (size_t i = 0; i < 1024; ++i) { f.insert(i * 7919); }
+  NTH_MEASURE() {
+    NTH_TIME("find") {
+      for (size_t i = 0; i < 1024; ++i) { nth::DoNotOptimize(f.find(i)); }
+    }
+    NTH_TIME("index") {
+      for (size_t i = 0; i < 1024; ++i) { nth::DoNotOptimize(f.index(i)); }
+    }
+    NTH_TIME("from_index") {
+      for (size_t i = 0; i < 1024; ++i) {
+        size_t value = f.from_index(i);
+        nth::DoNotOptimize(value);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace nth
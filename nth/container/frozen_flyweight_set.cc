@@ -0,0 +1,140 @@
+#include "nth/container/frozen_flyweight_set.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "nth/debug/debug.h"
+#include "nth/hash/fnv1a.h"
+
+namespace nth {
+namespace internal_frozen_flyweight_set {
+namespace {
+
+constexpr size_t align_up(size_t n, size_t alignment) {
+  return (n + alignment - 1) & ~(alignment - 1);
+}
+
+// Returns whether the `count` objects of type `T` starting at `p` lie entirely
+// within `bytes`.
+template <typename T>
+bool within(std::span<std::byte const> bytes, T const* p, uint64_t count) {
+  auto begin = reinterpret_cast<uintptr_t>(bytes.data());
+  auto end   = begin + bytes.size();
+  auto start = reinterpret_cast<uintptr_t>(p);
+  if (start < begin or start > end or start % alignof(T) != 0) { return false; }
+  return count <= (end - start) / sizeof(T);
+}
+
+}  // namespace
+
+uint64_t stable_hash(std::string_view s) {
+  // FNV-1a mixes the last few characters poorly into the low bits, which select
+  // the bucket, so the result is passed through a finalizer.
+  uint64_t h = fnv1a(s);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  return h;
+}
+
+std::vector<std::byte> freeze(std::span<std::string_view const> values) {
+  size_t bucket_count = std::bit_ceil(std::max<size_t>(1, 2 * values.size()));
+  size_t character_count = 0;
+  for (std::string_view v : values) { character_count += v.size(); }
+
+  size_t entries_offset = align_up(sizeof(header), alignof(entry));
+  size_t buckets_offset = align_up(
+      entries_offset + values.size() * sizeof(entry), alignof(uint64_t));
+  size_t characters_offset = buckets_offset + bucket_count * sizeof(uint64_t);
+
+  std::vector<std::byte> bytes(characters_offset + character_count);
+  std::byte* base = bytes.data();
+
+  auto* h = new (base) header{.magic        = Magic,
+                              .version      = Version,
+                              .reserved     = 0,
+                              .size         = values.size(),
+                              .bucket_count = bucket_count};
+  auto* entries    = reinterpret_cast<entry*>(base + entries_offset);
+  // Buckets are zero-initialized (i.e., empty) along with the rest of `bytes`.
+  auto* buckets    = reinterpret_cast<uint64_t*>(base + buckets_offset);
+  char* characters = reinterpret_cast<char*>(base + characters_offset);
+  h->entries       = entries;
+  h->buckets       = buckets;
+
+  size_t mask = bucket_count - 1;
+  for (size_t i = 0; i < values.size(); ++i) {
+    std::string_view v = values[i];
+    std::memcpy(characters, v.data(), v.size());
+    entry* e =
+        new (&entries[i]) entry{.hash = stable_hash(v), .length = v.size()};
+    e->data = characters;
+    characters += v.size();
+
+    size_t bucket = e->hash & mask;
+    while (buckets[bucket] != 0) { bucket = (bucket + 1) & mask; }
+    buckets[bucket] = i + 1;
+  }
+  return bytes;
+}
+
+}  // namespace internal_frozen_flyweight_set
+
+std::optional<frozen_flyweight_set> frozen_flyweight_set::from_bytes(
+    std::span<std::byte const> bytes) {
+  using internal_frozen_flyweight_set::header;
+  using internal_frozen_flyweight_set::within;
+  auto const* h = reinterpret_cast<header const*>(bytes.data());
+  if (not within(bytes, h, 1)) { return std::nullopt; }
+  if (h->magic != internal_frozen_flyweight_set::Magic or
+      h->version != internal_frozen_flyweight_set::Version) {
+    return std::nullopt;
+  }
+  if (not std::has_single_bit(h->bucket_count) or h->bucket_count <= h->size) {
+    return std::nullopt;
+  }
+  if (not within(bytes, h->entries.get(), h->size) or
+      not within(bytes, h->buckets.get(), h->bucket_count)) {
+    return std::nullopt;
+  }
+  // Every element is read through its entry, so check each one up front. This
+  // touches only the entries, not the characters they refer to.
+  for (auto const& e : std::span(h->entries.get(), h->size)) {
+    if (not within(bytes, e.data.get(), e.length)) { return std::nullopt; }
+  }
+  return frozen_flyweight_set(h);
+}
+
+size_t frozen_flyweight_set::index(std::string_view s) const {
+  auto const* entries = header_->entries.get();
+  auto const* buckets = header_->buckets.get();
+  uint64_t hash       = internal_frozen_flyweight_set::stable_hash(s);
+  size_t mask         = header_->bucket_count - 1;
+  for (size_t probe = 0, bucket = hash & mask; probe < header_->bucket_count;
+       ++probe, bucket = (bucket + 1) & mask) {
+    uint64_t slot = buckets[bucket];
+    if (slot == 0 or slot > header_->size) { break; }
+    auto const& e = entries[slot - 1];
+    if (e.hash == hash and std::string_view(e.data.get(), e.length) == s) {
+      return slot - 1;
+    }
+  }
+  return end_index();
+}
+
+std::string_view frozen_flyweight_set::from_index(size_t n) const {
+  NTH_REQUIRE((harden), n < size());
+  auto const& e = header_->entries.get()[n];
+  return std::string_view(e.data.get(), e.length);
+}
+
+}  // namespace nth
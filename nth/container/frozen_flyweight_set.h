@@ -0,0 +1,109 @@
+#ifndef NTH_CONTAINER_FROZEN_FLYWEIGHT_SET_H
+#define NTH_CONTAINER_FROZEN_FLYWEIGHT_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nth/base/attributes.h"
+#include "nth/container/flyweight_set.h"
+#include "nth/memory/offset_ptr.h"
+
+// This header provides a means of serializing a `flyweight_set<std::string>`
+// into a single contiguous, position-independent blob of bytes, and a
+// read-only view which answers queries directly against such a blob. Because
+// every pointer in the blob is an `nth::offset_ptr` relative to its own
+// location, the blob may be written to a file and later memory-mapped at any
+// address (by any number of processes) and queried without deserialization.
+//
+// The blob uses the native byte order and pointer width, and is only
+// meaningful to processes on the same platform.
+
+namespace nth {
+namespace internal_frozen_flyweight_set {
+
+inline constexpr uint64_t Magic   = 0x7a6f72662d68746e;  // "nth-froz"
+inline constexpr uint32_t Version = 1;
+
+struct entry {
+  uint64_t hash;
+  uint64_t length;
+  offset_ptr<char const> data;
+};
+
+// The index is an open-addressed table with linear probing, holding at most
+// half as many elements as it has buckets. Each bucket holds one more than the
+// index of an element, or zero if the bucket is empty.
+struct header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t size;
+  uint64_t bucket_count;
+  offset_ptr<entry const> entries;
+  offset_ptr<uint64_t const> buckets;
+};
+
+// A hash of `s` which, unlike `absl::Hash`, is identical in every process.
+uint64_t stable_hash(std::string_view s);
+
+std::vector<std::byte> freeze(std::span<std::string_view const> values);
+
+}  // namespace internal_frozen_flyweight_set
+
+// Returns a blob representing the contents of `set`, from which a
+// `frozen_flyweight_set` can be constructed. Each element retains its index.
+// To be viewed, the blob must be placed at an address suitably aligned for a
+// `uint64_t`, as is memory obtained from `mmap` or `operator new`.
+template <typename Hash, typename Eq, flyweight_set_options Options>
+std::vector<std::byte> freeze(
+    flyweight_set<std::string, Hash, Eq, Options> const& set) {
+  std::vector<std::string_view> values(set.begin(), set.end());
+  return internal_frozen_flyweight_set::freeze(values);
+}
+
+// A read-only view of the blob produced by `nth::freeze` applied to a
+// `flyweight_set<std::string>`. A `frozen_flyweight_set` does not own the
+// blob, which must outlive it.
+struct frozen_flyweight_set {
+  // Returns a view of `bytes`, or `std::nullopt` if `bytes` is not a
+  // well-formed blob. The header is validated, along with every entry, so
+  // that no query on the returned view reads outside of `bytes`. This takes
+  // time linear in the number of elements, but does not read the elements'
+  // characters.
+  static std::optional<frozen_flyweight_set> from_bytes(
+      std::span<std::byte const> bytes NTH_ATTRIBUTE(lifetimebound));
+
+  size_t size() const { return header_->size; }
+  bool empty() const { return size() == 0; }
+
+  // Returns the index of the element equal to `s` if it is present. If not
+  // present, returns `end_index()`.
+  size_t index(std::string_view s) const;
+
+  bool contains(std::string_view s) const { return index(s) != end_index(); }
+
+  // Returns the element indexed by `n`. Behavior is undefined if no such
+  // element exists.
+  std::string_view from_index(size_t n) const;
+
+  // Returns a value for which `index(s) == end_index()` is false for every
+  // `s` in the container.
+  size_t end_index() const { return std::numeric_limits<size_t>::max(); }
+
+ private:
+  explicit frozen_flyweight_set(
+      internal_frozen_flyweight_set::header const* header)
+      : header_(header) {}
+
+  internal_frozen_flyweight_set::header const* header_;
+};
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_FROZEN_FLYWEIGHT_SET_H
@@ -0,0 +1,95 @@
+#include "nth/container/frozen_flyweight_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "nth/container/flyweight_set.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("frozen_flyweight_set/empty") {
+  std::vector<std::byte> bytes = freeze(flyweight_set<std::string>{});
+  std::optional f              = frozen_flyweight_set::from_bytes(bytes);
+  NTH_ASSERT(f.has_value());
+  NTH_EXPECT(f->empty());
+  NTH_EXPECT(f->index("") == f->end_index());
+  NTH_EXPECT(not f->contains("a"));
+}
+
+NTH_TEST("frozen_flyweight_set/lookup") {
+  flyweight_set<std::string> set{"apple", "", "banana", "cherry"};
+  std::vector<std::byte> bytes = freeze(set);
+  std::optional f              = frozen_flyweight_set::from_bytes(bytes);
+  NTH_ASSERT(f.has_value());
+  NTH_EXPECT(f->size() == size_t{4});
+  for (size_t i = 0; i < set.size(); ++i) {
+    NTH_EXPECT(f->from_index(i) == set.from_index(i));
+    NTH_EXPECT(f->index(set.from_index(i)) == i);
+  }
+  NTH_EXPECT(f->index("durian") == f->end_index());
+  NTH_EXPECT(not f->contains("appl"));
+}
+
+NTH_TEST("frozen_flyweight_set/position-independent") {
+  flyweight_set<std::string> set;
+  for (int i = 0; i < 1000; ++i) { set.insert("symbol_" + std::to_string(i)); }
+  std::vector<std::byte> bytes = freeze(set);
+
+  // Copy the blob elsewhere, as if it had been written to a file and mapped
+  // into a different process, then discard the original.
+  auto relocated = std::make_unique<std::byte[]>(bytes.size());
+  std::memcpy(relocated.get(), bytes.data(), bytes.size());
+  std::fill(bytes.begin(), bytes.end(), std::byte{0});
+
+  std::optional f = frozen_flyweight_set::from_bytes(
+      std::span<std::byte const>(relocated.get(), bytes.size()));
+  NTH_ASSERT(f.has_value());
+  NTH_ASSERT(f->size() == size_t{1000});
+  for (int i = 0; i < 1000; ++i) {
+    NTH_ASSERT(f->index("symbol_" + std::to_string(i)) == size_t(i));
+    NTH_ASSERT(f->from_index(i) == "symbol_" + std::to_string(i));
+  }
+}
+
+NTH_TEST("frozen_flyweight_set/malformed") {
+  std::vector<std::byte> bytes = freeze(flyweight_set<std::string>{"a", "b"});
+  NTH_EXPECT(not frozen_flyweight_set::from_bytes(
+                     std::span<std::byte const>(bytes).first(8))
+                     .has_value());
+  NTH_EXPECT(not frozen_flyweight_set::from_bytes(
+                     std::span<std::byte const>(bytes).first(bytes.size() / 2))
+                     .has_value());
+
+  bytes[0] = std::byte{0};
+  NTH_EXPECT(not frozen_flyweight_set::from_bytes(bytes).has_value());
+}
+
+NTH_TEST("frozen_flyweight_set/malformed-entries") {
+  std::vector<std::byte> bytes = freeze(flyweight_set<std::string>{"a", "b"});
+  NTH_ASSERT(frozen_flyweight_set::from_bytes(bytes).has_value());
+
+  // The last character lies beyond a truncated blob, though the header and
+  // tables do not.
+  NTH_EXPECT(not frozen_flyweight_set::from_bytes(
+                     std::span<std::byte const>(bytes).first(bytes.size() - 1))
+                     .has_value());
+
+  auto const* h =
+      reinterpret_cast<internal_frozen_flyweight_set::header const*>(
+          bytes.data());
+  auto* e = const_cast<internal_frozen_flyweight_set::entry*>(h->entries.get());
+  e->length = uint64_t{1} << 40;
+  NTH_EXPECT(not frozen_flyweight_set::from_bytes(bytes).has_value());
+}
+
+}  // namespace
+}  // namespace nth
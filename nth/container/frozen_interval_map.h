@@ -0,0 +1,95 @@
+#ifndef NTH_CONTAINER_FROZEN_INTERVAL_MAP_H
+#define NTH_CONTAINER_FROZEN_INTERVAL_MAP_H
+
+#include <concepts>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "nth/container/internal/eytzinger.h"
+#include "nth/container/interval.h"
+#include "nth/container/interval_map.h"
+#include "nth/debug/debug.h"
+
+namespace nth {
+
+// A `frozen_interval_map<K, M>` is an immutable snapshot of an
+// `interval_map<K, M>` optimized for lookups in hot read-only tables.
+//
+// Intervals are stored in Eytzinger (breadth-first) order, which a search
+// descends with a branch-free loop and a cache-friendly access pattern. Only
+// the bounds of each interval are consulted during the search; mapped values
+// are stored separately in the same order, so that large mapped values do not
+// dilute the cache lines holding the bounds.
+template <std::totally_ordered K, std::equality_comparable M>
+struct frozen_interval_map {
+  using key_type      = K;
+  using interval_type = ::nth::interval<key_type>;
+  using mapped_type   = M;
+
+  explicit frozen_interval_map(interval_map<K, M> const& map);
+
+  // Returns the number of disjoint intervals in the map.
+  size_t size() const { return nodes_.size(); }
+
+  // Returns `true` if the map is empty and `false` otherwise.
+  bool empty() const { return size() == 0; }
+
+  // Returns `true` if and only if the key `k` is contained in one of the
+  // intervals in the map.
+  bool contains(key_type const& k) const { return find(k) != nullptr; }
+
+  // If `k` is contained in the map, returns a pointer to the corresponding
+  // mapped value. Returns `nullptr` otherwise.
+  mapped_type const* find(key_type const& k) const {
+    size_t n = internal_container::eytzinger_last(
+        size(), [&](size_t p) { return node_at(p).lower_bound <= k; });
+    return (n != 0 and k < node_at(n).upper_bound) ? &values_[n - 1]
+                                                    : nullptr;
+  }
+
+  // If `k` is contained in the map, returns the corresponding mapped value.
+  // Behavior is undefined otherwise.
+  mapped_type const& at(key_type const& k) const {
+    mapped_type const* m = find(k);
+    NTH_REQUIRE((harden), m != nullptr);
+    return *m;
+  }
+
+ private:
+  struct node {
+    key_type lower_bound;
+    key_type upper_bound;
+  };
+
+  // Positions are numbered from 1 so that the children of `n` are at `2n` and
+  // `2n+1`.
+  node const& node_at(size_t n) const { return nodes_[n - 1]; }
+
+  std::vector<node> nodes_;
+  // The value mapped from the interval in `nodes_[n]` is `values_[n]`.
+  std::vector<mapped_type> values_;
+};
+
+template <std::totally_ordered K, std::equality_comparable M>
+frozen_interval_map(interval_map<K, M> const&) -> frozen_interval_map<K, M>;
+
+template <std::totally_ordered K, std::equality_comparable M>
+frozen_interval_map<K, M>::frozen_interval_map(interval_map<K, M> const& map) {
+  std::vector<std::pair<interval_type const, mapped_type> const*> sorted;
+  for (auto const& entry : map.mapped_intervals()) {
+    if (not entry.first.empty()) { sorted.push_back(&entry); }
+  }
+  nodes_.reserve(sorted.size());
+  values_.reserve(sorted.size());
+  for (size_t i : internal_container::eytzinger_order(sorted.size())) {
+    auto const& [range, value] = *sorted[i];
+    nodes_.push_back({.lower_bound = range.lower_bound(),
+                      .upper_bound = range.upper_bound()});
+    values_.push_back(value);
+  }
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_FROZEN_INTERVAL_MAP_H
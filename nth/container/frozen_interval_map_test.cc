@@ -0,0 +1,70 @@
+#include "nth/container/frozen_interval_map.h"
+
+#include <cstdint>
+#include <string>
+
+#include "nth/container/interval_map.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("frozen_interval_map/empty") {
+  interval_map<int, std::string> map;
+  frozen_interval_map frozen(map);
+  NTH_EXPECT(frozen.empty());
+  NTH_EXPECT(frozen.size() == size_t{0});
+  NTH_EXPECT(frozen.find(0) == nullptr);
+  NTH_EXPECT(not frozen.contains(0));
+}
+
+NTH_TEST("frozen_interval_map/find", size_t count) {
+  interval_map<int, std::string> map;
+  for (size_t i = 0; i < count; ++i) {
+    int lower = static_cast<int>(i * 10);
+    map.insert_or_assign(interval(lower, lower + 5), std::to_string(i));
+  }
+  frozen_interval_map frozen(map);
+  NTH_ASSERT(frozen.size() == count);
+  for (int k = -10; k < static_cast<int>(count * 10) + 10; ++k) {
+    NTH_ASSERT(frozen.contains(k) == map.contains(k));
+    if (map.contains(k)) { NTH_EXPECT(frozen.at(k) == map.at(k)); }
+  }
+}
+
+NTH_INVOKE_TEST("frozen_interval_map/find") {
+  for (size_t count : {1, 2, 3, 7, 8, 9, 100, 1000}) { co_yield count; }
+}
+
+NTH_TEST("frozen_interval_map/benchmark/find", size_t count) {
+  interval_map<uint64_t, uint64_t> map;
+  for (uint64_t i = 0; i < count; ++i) {
+    map.insert_or_assign(interval(i * 1024, i * 1024 + 512), i);
+  }
+  frozen_interval_map frozen(map);
+  NTH_MEASURE() {
+    NTH_TIME("interval_map") {
+      for (uint64_t i = 0; i < 1024; ++i) {
+        auto const* entry =
+            map.mapped_range((i * 0x9e3779b97f4a7c15) % (count * 1024));
+        nth::DoNotOptimize(entry);
+      }
+    }
+    NTH_TIME("frozen_interval_map") {
+      for (uint64_t i = 0; i < 1024; ++i) {
+        auto const* value =
+            frozen.find((i * 0x9e3779b97f4a7c15) % (count * 1024));
+        nth::DoNotOptimize(value);
+      }
+    }
+  }
+}
+
+NTH_INVOKE_TEST("frozen_interval_map/benchmark/find") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 18;
+}
+
+}  // namespace
+}  // namespace nth
@@ -0,0 +1,88 @@
+#ifndef NTH_CONTAINER_FROZEN_INTERVAL_SET_H
+#define NTH_CONTAINER_FROZEN_INTERVAL_SET_H
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "nth/container/internal/eytzinger.h"
+#include "nth/container/interval.h"
+#include "nth/container/interval_set.h"
+
+namespace nth {
+
+// A `frozen_interval_set<T>` is an immutable snapshot of an `interval_set<T>`
+// optimized for membership queries over very large sets.
+//
+// Intervals are stored in Eytzinger (breadth-first) order, which a search
+// descends with a branch-free loop and a cache-friendly access pattern. Each
+// node stores both bounds of its interval so that the final comparison needs
+// no further memory access.
+template <std::totally_ordered T>
+struct frozen_interval_set {
+  using interval_type = interval<T>;
+  using value_type    = T;
+
+  explicit frozen_interval_set(interval_set<T> const& set);
+
+  // Returns the number of disjoint intervals in the set.
+  size_t size() const { return nodes_.size(); }
+
+  // Returns `true` if the set is empty and `false` otherwise.
+  bool empty() const { return size() == 0; }
+
+  // Returns `true` if and only if the element `u` is contained in one of the
+  // intervals in the set.
+  template <std::totally_ordered_with<T> U>
+  bool contains(U const& u) const {
+    node const* n = last_starting_at_or_before(u);
+    return n and u < n->upper_bound;
+  }
+
+  // Returns `true` if and only if the interval `i` is completely covered by
+  // some interval in the set.
+  template <std::totally_ordered_with<T> U>
+  bool covers(interval<U> const& i) const {
+    node const* n = last_starting_at_or_before(i.lower_bound());
+    return n and i.upper_bound() <= n->upper_bound;
+  }
+
+ private:
+  struct node {
+    value_type lower_bound;
+    value_type upper_bound;
+  };
+
+  // Returns the node with the greatest lower bound not exceeding `u`, or null
+  // if there is no such node.
+  template <std::totally_ordered_with<T> U>
+  node const* last_starting_at_or_before(U const& u) const {
+    size_t k = internal_container::eytzinger_last(
+        size(), [&](size_t n) { return node_at(n).lower_bound <= u; });
+    return k == 0 ? nullptr : &node_at(k);
+  }
+
+  // Positions are numbered from 1 so that the children of `k` are at `2k` and
+  // `2k+1`.
+  node const& node_at(size_t k) const { return nodes_[k - 1]; }
+
+  std::vector<node> nodes_;
+};
+
+template <std::totally_ordered T>
+frozen_interval_set(interval_set<T> const&) -> frozen_interval_set<T>;
+
+template <std::totally_ordered T>
+frozen_interval_set<T>::frozen_interval_set(interval_set<T> const& set) {
+  std::span intervals = set.intervals();
+  nodes_.reserve(intervals.size());
+  for (size_t i : internal_container::eytzinger_order(intervals.size())) {
+    nodes_.push_back({.lower_bound = intervals[i].lower_bound(),
+                      .upper_bound = intervals[i].upper_bound()});
+  }
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_FROZEN_INTERVAL_SET_H
@@ -0,0 +1,72 @@
+#include "nth/container/frozen_interval_set.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "nth/container/interval_set.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+NTH_TEST("frozen_interval_set/empty") {
+  interval_set<int> set;
+  frozen_interval_set frozen(set);
+  NTH_EXPECT(frozen.empty());
+  NTH_EXPECT(frozen.size() == size_t{0});
+  NTH_EXPECT(not frozen.contains(0));
+  NTH_EXPECT(not frozen.covers(interval(0, 0)));
+}
+
+NTH_TEST("frozen_interval_set/contains", size_t count) {
+  interval_set<int> set;
+  for (size_t i = 0; i < count; ++i) {
+    int lower = static_cast<int>(i * 10);
+    set.insert(interval(lower, lower + 5));
+  }
+  frozen_interval_set frozen(set);
+  NTH_ASSERT(frozen.size() == count);
+  for (int n = -10; n < static_cast<int>(count * 10) + 10; ++n) {
+    NTH_EXPECT(frozen.contains(n) == set.contains(n));
+    NTH_EXPECT(frozen.covers(interval(n, n + 3)) ==
+               set.covers(interval(n, n + 3)));
+  }
+}
+
+NTH_INVOKE_TEST("frozen_interval_set/contains") {
+  for (size_t count : {1, 2, 3, 7, 8, 9, 100, 1000}) { co_yield count; }
+}
+
+NTH_TEST("frozen_interval_set/benchmark/contains", size_t count) {
+  interval_set<uint64_t> set;
+  std::vector<interval<uint64_t>> intervals;
+  for (uint64_t i = 0; i < count; ++i) {
+    intervals.push_back(interval(i * 1024, i * 1024 + 512));
+  }
+  set.insert_range(intervals);
+  frozen_interval_set frozen(set);
+  NTH_MEASURE() {
+    NTH_TIME("interval_set") {
+      for (uint64_t i = 0; i < 1024; ++i) {
+        bool result = set.contains((i * 0x9e3779b97f4a7c15) % (count * 1024));
+        nth::DoNotOptimize(result);
+      }
+    }
+    NTH_TIME("frozen_interval_set") {
+      for (uint64_t i = 0; i < 1024; ++i) {
+        bool result =
+            frozen.contains((i * 0x9e3779b97f4a7c15) % (count * 1024));
+        nth::DoNotOptimize(result);
+      }
+    }
+  }
+}
+
+NTH_INVOKE_TEST("frozen_interval_set/benchmark/contains") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 20;
+}
+
+}  // namespace
+}  // namespace nth
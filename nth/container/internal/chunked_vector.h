@@ -0,0 +1,270 @@
+#ifndef NTH_CONTAINER_INTERNAL_CHUNKED_VECTOR_H
+#define NTH_CONTAINER_INTERNAL_CHUNKED_VECTOR_H
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nth::internal_container {
+
+// Chunks are sized to hold at least 16 elements and at least 1KiB, rounded up
+// to a power of two.
+template <typename T>
+constexpr size_t default_chunk_size_log2() {
+  size_t elements = std::max<size_t>(16, 1024 / sizeof(T));
+  return std::bit_width(std::bit_ceil(elements)) - 1;
+}
+
+// A `chunked_vector<T>` is a sequence container supporting insertion only at
+// the end. Elements are stored in fixed-size chunks of `1 << ChunkSizeLog2`
+// contiguous elements, so that locating the `n`th element is a shift, a mask,
+// and two loads, and so that growing the container never moves existing
+// elements. Pointers and references to elements are invalidated only by
+// `clear`, assignment, or destruction of the container. Iterators are
+// invalidated by any insertion.
+template <typename T, size_t ChunkSizeLog2 = default_chunk_size_log2<T>()>
+struct chunked_vector {
+  using value_type      = T;
+  using size_type       = size_t;
+  using difference_type = ptrdiff_t;
+  using reference       = value_type&;
+  using const_reference = value_type const&;
+  using pointer         = value_type*;
+  using const_pointer   = value_type const*;
+
+  static constexpr size_type chunk_size = size_type{1} << ChunkSizeLog2;
+
+  template <bool Const>
+  struct iterator_impl;
+
+  using iterator               = iterator_impl<false>;
+  using const_iterator         = iterator_impl<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  chunked_vector() = default;
+
+  // Delegates to the default constructor so that, should copying an element
+  // throw, the destructor releases the chunks and the elements already copied.
+  chunked_vector(chunked_vector const& v) : chunked_vector() {
+    reserve(v.size_);
+    for (value_type const& element : v) { emplace_back(element); }
+  }
+
+  chunked_vector(chunked_vector&& v) noexcept
+      : chunks_(std::move(v.chunks_)), size_(std::exchange(v.size_, 0)) {
+    v.chunks_.clear();
+  }
+
+  // Copies into a separate container first, so that `*this` is left unchanged
+  // should copying an element throw.
+  chunked_vector& operator=(chunked_vector const& v) {
+    if (this == &v) { return *this; }
+    return *this = chunked_vector(v);
+  }
+
+  chunked_vector& operator=(chunked_vector&& v) noexcept {
+    if (this == &v) { return *this; }
+    clear();
+    deallocate();
+    chunks_ = std::move(v.chunks_);
+    size_   = std::exchange(v.size_, 0);
+    v.chunks_.clear();
+    return *this;
+  }
+
+  ~chunked_vector() {
+    clear();
+    deallocate();
+  }
+
+  [[nodiscard]] size_type size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+  [[nodiscard]] size_type capacity() const {
+    return chunks_.size() << ChunkSizeLog2;
+  }
+
+  // Ensures that at least `n` elements can be held without allocating.
+  void reserve(size_type n) {
+    size_type chunks = (n + chunk_size - 1) >> ChunkSizeLog2;
+    if (chunks <= chunks_.size()) { return; }
+    chunks_.reserve(chunks);
+    while (chunks_.size() < chunks) { allocate_chunk(); }
+  }
+
+  // Destroys all elements. Allocated chunks are retained for reuse.
+  void clear() {
+    if constexpr (not std::is_trivially_destructible_v<value_type>) {
+      for (size_type i = 0; i < size_; ++i) { std::destroy_at(slot(i)); }
+    }
+    size_ = 0;
+  }
+
+  [[nodiscard]] reference operator[](size_type n) { return *slot(n); }
+  [[nodiscard]] const_reference operator[](size_type n) const {
+    return *slot(n);
+  }
+
+  [[nodiscard]] reference front() { return *slot(0); }
+  [[nodiscard]] const_reference front() const { return *slot(0); }
+  [[nodiscard]] reference back() { return *slot(size_ - 1); }
+  [[nodiscard]] const_reference back() const { return *slot(size_ - 1); }
+
+  reference push_back(value_type const& v) { return emplace_back(v); }
+  reference push_back(value_type&& v) { return emplace_back(std::move(v)); }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (size_ == capacity()) { allocate_chunk(); }
+    value_type* p =
+        std::construct_at(slot(size_), std::forward<Args>(args)...);
+    ++size_;
+    return *p;
+  }
+
+  [[nodiscard]] iterator begin() { return iterator(chunks_.data(), 0); }
+  [[nodiscard]] iterator end() { return iterator(chunks_.data(), size_); }
+  [[nodiscard]] const_iterator begin() const {
+    return const_iterator(chunks_.data(), 0);
+  }
+  [[nodiscard]] const_iterator end() const {
+    return const_iterator(chunks_.data(), size_);
+  }
+  [[nodiscard]] const_iterator cbegin() const { return begin(); }
+  [[nodiscard]] const_iterator cend() const { return end(); }
+  [[nodiscard]] reverse_iterator rbegin() { return reverse_iterator(end()); }
+  [[nodiscard]] reverse_iterator rend() { return reverse_iterator(begin()); }
+  [[nodiscard]] const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  [[nodiscard]] const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  [[nodiscard]] const_reverse_iterator crbegin() const { return rbegin(); }
+  [[nodiscard]] const_reverse_iterator crend() const { return rend(); }
+
+ private:
+  static constexpr size_type Mask = chunk_size - 1;
+
+  value_type* slot(size_type n) const {
+    return chunks_[n >> ChunkSizeLog2] + (n & Mask);
+  }
+
+  void allocate_chunk() {
+    chunks_.push_back(static_cast<value_type*>(::operator new(
+        sizeof(value_type) * chunk_size, std::align_val_t{alignof(T)})));
+  }
+
+  void deallocate() {
+    for (value_type* chunk : chunks_) {
+      ::operator delete(chunk, std::align_val_t{alignof(T)});
+    }
+    chunks_.clear();
+  }
+
+  std::vector<value_type*> chunks_;
+  size_type size_ = 0;
+};
+
+template <typename T, size_t ChunkSizeLog2>
+template <bool Const>
+struct chunked_vector<T, ChunkSizeLog2>::iterator_impl {
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type        = T;
+  using difference_type   = ptrdiff_t;
+  using reference         = std::conditional_t<Const, T const&, T&>;
+  using pointer           = std::conditional_t<Const, T const*, T*>;
+
+  iterator_impl() = default;
+
+  // Mutable iterators are implicitly convertible to const iterators.
+  operator iterator_impl<true>() const
+    requires(not Const)
+  {
+    return iterator_impl<true>(chunks_, index_);
+  }
+
+  [[nodiscard]] reference operator*() const {
+    return chunks_[index_ >> ChunkSizeLog2][index_ & Mask];
+  }
+  [[nodiscard]] pointer operator->() const { return std::addressof(**this); }
+  [[nodiscard]] reference operator[](difference_type n) const {
+    return *(*this + n);
+  }
+
+  iterator_impl& operator++() {
+    ++index_;
+    return *this;
+  }
+  iterator_impl operator++(int) {
+    auto copy = *this;
+    ++index_;
+    return copy;
+  }
+  iterator_impl& operator--() {
+    --index_;
+    return *this;
+  }
+  iterator_impl operator--(int) {
+    auto copy = *this;
+    --index_;
+    return copy;
+  }
+
+  iterator_impl& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
+  }
+  iterator_impl& operator-=(difference_type n) {
+    index_ -= n;
+    return *this;
+  }
+
+  [[nodiscard]] friend iterator_impl operator+(iterator_impl i,
+                                               difference_type n) {
+    return i += n;
+  }
+  [[nodiscard]] friend iterator_impl operator+(difference_type n,
+                                               iterator_impl i) {
+    return i += n;
+  }
+  [[nodiscard]] friend iterator_impl operator-(iterator_impl i,
+                                               difference_type n) {
+    return i -= n;
+  }
+  [[nodiscard]] friend difference_type operator-(iterator_impl const& lhs,
+                                                 iterator_impl const& rhs) {
+    return static_cast<difference_type>(lhs.index_) -
+           static_cast<difference_type>(rhs.index_);
+  }
+
+  [[nodiscard]] friend bool operator==(iterator_impl const& lhs,
+                                       iterator_impl const& rhs) {
+    return lhs.index_ == rhs.index_;
+  }
+  [[nodiscard]] friend std::strong_ordering operator<=>(
+      iterator_impl const& lhs, iterator_impl const& rhs) {
+    return lhs.index_ <=> rhs.index_;
+  }
+
+ private:
+  friend chunked_vector;
+  friend iterator_impl<not Const>;
+
+  explicit iterator_impl(value_type* const* chunks, size_type index)
+      : chunks_(chunks), index_(index) {}
+
+  value_type* const* chunks_ = nullptr;
+  size_type index_           = 0;
+};
+
+}  // namespace nth::internal_container
+
+#endif  // NTH_CONTAINER_INTERNAL_CHUNKED_VECTOR_H
@@ -0,0 +1,54 @@
+#ifndef NTH_CONTAINER_INTERNAL_EYTZINGER_H
+#define NTH_CONTAINER_INTERNAL_EYTZINGER_H
+
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Utilities for laying out sorted sequences in Eytzinger (breadth-first)
+// order: the root of an implicit balanced binary search tree is at position 1,
+// and the children of position `k` are at positions `2k` and `2k+1`. A search
+// walks down the array touching positions which are close together near the
+// root (and so share cache lines across queries), and its branch-free loop has
+// a predictable memory access pattern, unlike a binary search over the sorted
+// sequence which jumps across the entire array.
+
+namespace nth::internal_container {
+namespace internal_eytzinger {
+
+inline size_t assign(std::span<size_t> order, size_t i, size_t k) {
+  if (k > order.size()) { return i; }
+  i            = assign(order, i, 2 * k);
+  order[k - 1] = i;
+  return assign(order, i + 1, 2 * k + 1);
+}
+
+}  // namespace internal_eytzinger
+
+// Returns a vector `order` of length `n` such that, for a sorted sequence `s`,
+// position `k` of the Eytzinger layout of `s` holds `s[order[k - 1]]`.
+inline std::vector<size_t> eytzinger_order(size_t n) {
+  std::vector<size_t> order(n);
+  internal_eytzinger::assign(order, 0, 1);
+  return order;
+}
+
+// Given an Eytzinger layout of `n` elements and a predicate `before` which
+// holds for some prefix of the elements in sorted order (when invoked with an
+// element's position), returns the position of the last element for which
+// `before` holds, or zero if it holds for none of them.
+template <typename Before>
+size_t eytzinger_last(size_t n, Before before) {
+  size_t k = 1;
+  while (k <= n) { k = 2 * k + static_cast<size_t>(before(k)); }
+  // Each step appended one bit to `k`: 1 where the search went right and 0
+  // where it went left. The answer is the last position at which the search
+  // went right, found by discarding the trailing left turns along with that
+  // final right turn.
+  return k >> (std::countr_zero(k) + 1);
+}
+
+}  // namespace nth::internal_container
+
+#endif  // NTH_CONTAINER_INTERNAL_EYTZINGER_H
@@ -10,6 +10,22 @@ namespace nth::internal_container {
 struct Index {
   size_t value;
 };
+
+// An `Index` along with the hash of the value to which it refers, so that
+// the hash need not be recomputed when the table holding it is resized, and so
+// that comparisons can be skipped when hashes differ.
+struct HashedIndex {
+  size_t value;
+  size_t hash;
+};
+
+// A key being looked up in a table of `HashedIndex`, along with its
+// precomputed hash.
+template <typename T>
+struct HashedKey {
+  T const& value;
+  size_t hash;
+};
 }  // namespace nth::internal_container
 
 #endif  // NTH_CONTAINER_INTERNAL_INDEX_H
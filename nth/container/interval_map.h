@@ -1,8 +1,16 @@
 #ifndef NTH_CONTAINER_INTERVAL_MAP_H
 #define NTH_CONTAINER_INTERVAL_MAP_H
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "nth/container/interval.h"
@@ -12,17 +20,42 @@
 namespace nth {
 namespace internal_interval_map {
 
+// A key used for heterogeneous lookup of the interval containing `value`.
+template <typename K>
+struct Point {
+  K const& value;
+};
+
+// Orders the intervals keying an `interval_map`. Every mutation maintains the
+// invariant that these intervals are disjoint and non-empty, on which both the
+// heterogeneous lookup below and `interval_map::overlapping` rely.
 template <typename K>
 struct Cmp {
+  using is_transparent = void;
+
   constexpr bool operator()(::nth::interval<K> const& lhs,
                             ::nth::interval<K> const& rhs) const {
     if (lhs.lower_bound() < rhs.lower_bound()) { return true; }
     if (rhs.lower_bound() < lhs.lower_bound()) { return false; }
     return lhs.upper_bound() < rhs.upper_bound();
   }
+
+  // Intervals in an `interval_map` are disjoint, so any key partitions them
+  // into those entirely before the key, at most one containing the key, and
+  // those entirely after the key.
+  constexpr bool operator()(::nth::interval<K> const& lhs, Point<K> rhs) const {
+    return lhs.upper_bound() <= rhs.value;
+  }
+  constexpr bool operator()(Point<K> lhs, ::nth::interval<K> const& rhs) const {
+    return lhs.value < rhs.lower_bound();
+  }
 };
+
 }  // namespace internal_interval_map
 
+template <std::totally_ordered K, std::equality_comparable M>
+struct interval_map_builder;
+
 // Represents an association of keys of type `K` with associated mapped values
 // of type `M`, by storing a mapping from `nth::interval<K>` to `M` in an
 // ordered associative container. The mapping is useful when ranges of values
@@ -61,6 +94,13 @@ struct interval_map {
             std::equality_comparable_with<mapped_type> V>
   void insert_or_assign(::nth::interval<T> const& i, V&& v);
 
+  // Assigns each (interval, value) pair in the range [`b`, `e`) in order, with
+  // the same result as calling `insert_or_assign` on each. Unless the range is
+  // small relative to the map, rather than updating the map once per pair, the
+  // map is rebuilt in a single pass, as by `interval_map_builder`.
+  template <std::input_iterator Iter, std::sentinel_for<Iter> S>
+  void insert_or_assign(Iter b, S e);
+
   // If `k` is contained in the map, returns a pointer to the mapped range
   // containing `k`. Returns `nullptr` otherwise. The pointer is guaranteed to
   // remain valid until the next mutation of the map.
@@ -78,6 +118,34 @@ struct interval_map {
   std::pair<interval_type const, mapped_type> const* mapped_range(
       key_type const& k) const;
 
+  // For each key in `keys`, which must be sorted in increasing order, sets the
+  // corresponding element of `out` to point to the mapped value of that key,
+  // or to null if the key is not contained in the map. Rather than searching
+  // for each key independently, this walks the keys and the map together,
+  // jumping ahead with a search only when consecutive keys are far apart. The
+  // pointers are guaranteed to remain valid until the next mutation of the
+  // map.
+  void mapped_values(std::span<key_type const> keys,
+                     std::span<mapped_type const*> out) const;
+
+  // Returns a view of the entries in the map whose intervals share at least
+  // one key with `i`, in increasing order. The view is valid until the next
+  // mutation of the map.
+  auto overlapping(interval_type const& i) const {
+    auto b = intervals_.end();
+    auto e = intervals_.end();
+    if (not i.empty()) {
+      b = intervals_.lower_bound(
+          internal_interval_map::Point<key_type>{i.lower_bound()});
+      e = intervals_.lower_bound(
+          internal_interval_map::Point<key_type>{i.upper_bound()});
+      if (e != intervals_.end() and e->first.lower_bound() < i.upper_bound()) {
+        ++e;
+      }
+    }
+    return std::ranges::subrange(b, e);
+  }
+
   // Returns a view into the intervals present in the interval map along with
   // their corresponding mapped values in increasing order. The view is valid
   // until the next non-const member function is invoked on this `interval_map`.
@@ -105,21 +173,8 @@ struct interval_map {
   using const_iterator = typename map_type::const_iterator;
   using value_type     = typename map_type::value_type;
 
-  // Returns an iterator referencing first interval of the range from `b` to `e`
-  // whose lower bound begins strictly after the lower bound of `i`. Returns `e`
-  // if all elements of the range start before the lower bound of `i`, and `b`
-  // if none of them do.
-  static iterator FirstStartingAfter(iterator b, iterator e,
-                                     key_type const& k) {
-    return std::partition_point(b, e, [&](value_type const& entry) {
-      return entry.first.lower_bound() <= k;
-    });
-  }
-  static iterator FirstStartingNotBefore(iterator b, iterator e,
-                                         key_type const& k) {
-    return std::partition_point(b, e, [&](value_type const& entry) {
-      return entry.first.lower_bound() < k;
-    });
+  const_iterator Containing(key_type const& k) const {
+    return intervals_.find(internal_interval_map::Point<key_type>{k});
   }
 
   static const_iterator RangeContaining(const_iterator b, const_iterator e,
@@ -137,6 +192,8 @@ struct interval_map {
   constexpr bool covers_impl(const_iterator& it,
                              ::nth::interval<T> const& i) const;
 
+  friend interval_map_builder<K, M>;
+
   map_type intervals_;
 };
 
@@ -185,77 +242,98 @@ constexpr bool interval_map<K, M>::covers(interval_set<T> const& is) const {
 template <std::totally_ordered K, std::equality_comparable M>
 template <std::totally_ordered_with<K> T, std::equality_comparable_with<M> V>
 void interval_map<K, M>::insert_or_assign(::nth::interval<T> const& i, V&& v) {
-  if (intervals_.empty()) {
-    intervals_.emplace(i, std::forward<V>(v));
-    return;
-  }
-
-  iterator inserted_iter;
-  auto start_iter =
-      FirstStartingAfter(intervals_.begin(), intervals_.end(), i.lower_bound());
-  if (start_iter == intervals_.end()) {
-    inserted_iter = intervals_.emplace(i, std::forward<V>(v)).first;
-  } else if (start_iter->first.upper_bound() > i.upper_bound()) {
-    if (start_iter->first.lower_bound() > i.upper_bound()) {
-      inserted_iter =
-          intervals_.emplace_hint(start_iter, i, std::forward<V>(v));
-    } else if (start_iter->second == v) {
-      auto handle = intervals_.extract(start_iter);
-      handle.key().set_lower_bound(i.lower_bound());
-      auto result   = intervals_.insert(std::move(handle));
-      inserted_iter = result.position;
-    } else if (start_iter->first.lower_bound() == i.upper_bound()) {
-      inserted_iter =
-          intervals_.emplace_hint(start_iter, i, std::forward<V>(v));
+  if (i.empty()) { return; }
+  key_type lower = i.lower_bound();
+  key_type upper = i.upper_bound();
+
+  // Entries in [b, e) overlap `i` and will be replaced. Portions of the first
+  // and last of them extending beyond `i` are kept as `left` and `right`,
+  // unless they are mapped to `v`, in which case the new entry absorbs them.
+  auto b =
+      intervals_.lower_bound(internal_interval_map::Point<key_type>{lower});
+  auto e = b;
+  while (e != intervals_.end() and e->first.lower_bound() < upper) { ++e; }
+
+  std::optional<value_type> left, right;
+  if (b != e and b->first.lower_bound() < lower) {
+    if (b->second == v) {
+      lower = b->first.lower_bound();
     } else {
-      auto handle = intervals_.extract(start_iter);
-      handle.key().set_lower_bound(i.upper_bound());
-      auto iter     = intervals_.insert(std::move(handle)).position;
-      inserted_iter = intervals_.emplace_hint(iter, i, std::forward<V>(v));
+      left.emplace(interval_type(b->first.lower_bound(), lower), b->second);
     }
-  } else {
-    auto end_iter =
-        FirstStartingNotBefore(start_iter, intervals_.end(), i.upper_bound());
-    auto iter = intervals_.erase(start_iter, end_iter);
-    if (iter != intervals_.end() and iter->second == v) {
-      auto handle = intervals_.extract(iter);
-      handle.key().set_lower_bound(i.lower_bound());
-      inserted_iter = intervals_.insert(std::move(handle)).position;
-    } else {
-      inserted_iter = intervals_.emplace_hint(iter, i, std::forward<V>(v));
+  }
+  if (b != e) {
+    auto last = std::prev(e);
+    if (upper < last->first.upper_bound()) {
+      if (last->second == v) {
+        upper = last->first.upper_bound();
+      } else {
+        right.emplace(interval_type(upper, last->first.upper_bound()),
+                      last->second);
+      }
     }
   }
 
-  // Check if it overlaps with the previous interval.
-  if (inserted_iter == intervals_.begin()) { return; }
-  auto prev_iter = std::prev(inserted_iter);
-  if (prev_iter->first.upper_bound() < inserted_iter->first.lower_bound()) {
-    return;
+  // Coalesce with abutting neighbors mapped to the same value.
+  if (not left and b != intervals_.begin()) {
+    auto prev = std::prev(b);
+    if (prev->first.upper_bound() == lower and prev->second == v) {
+      lower = prev->first.lower_bound();
+      b     = prev;
+    }
   }
-  if (prev_iter->second == inserted_iter->second) {
-    auto u      = inserted_iter->first.upper_bound();
-    prev_iter   = std::prev(intervals_.erase(inserted_iter));
-    auto handle = intervals_.extract(prev_iter);
-    handle.key().set_upper_bound(std::move(u));
-    if (not handle.key().empty()) { intervals_.insert(std::move(handle)); }
-  } else {
-    auto handle = intervals_.extract(prev_iter);
-    handle.key().set_upper_bound(i.lower_bound());
-    if (not handle.key().empty()) { intervals_.insert(std::move(handle)); }
+  if (not right and e != intervals_.end() and
+      e->first.lower_bound() == upper and e->second == v) {
+    upper = e->first.upper_bound();
+    ++e;
   }
+
+  auto hint = intervals_.erase(b, e);
+  if (right) { hint = intervals_.insert(hint, *std::move(right)); }
+  hint = intervals_.emplace_hint(hint, interval_type(std::move(lower), upper),
+                                 std::forward<V>(v));
+  if (left) { intervals_.insert(hint, *std::move(left)); }
 }
+
+template <std::totally_ordered K, std::equality_comparable M>
+template <std::input_iterator Iter, std::sentinel_for<Iter> S>
+void interval_map<K, M>::insert_or_assign(Iter b, S e) {
+  // Rebuilding visits every entry already in the map, so a batch which is
+  // small relative to the map is cheaper to assign one pair at a time.
+  constexpr size_t RebuildRatio = 8;
+  if constexpr (std::forward_iterator<Iter>) {
+    if (static_cast<size_t>(std::ranges::distance(b, e)) * RebuildRatio <
+        intervals_.size()) {
+      for (; b != e; ++b) {
+        auto&& [i, v] = *b;
+        insert_or_assign(i, v);
+      }
+      return;
+    }
+  }
+
+  interval_map_builder<K, M> builder;
+  builder.reserve(intervals_.size());
+  for (auto const& [i, v] : intervals_) { builder.insert_or_assign(i, v); }
+  for (; b != e; ++b) {
+    auto&& [i, v] = *b;
+    builder.insert_or_assign(i, v);
+  }
+  *this = std::move(builder).build();
+}
+
 template <std::totally_ordered K, std::equality_comparable M>
 ::nth::interval<K> const* interval_map<K, M>::key_range(
     key_type const& k) const {
   interval_type const* result;
   NTH_ENSURE((debug), not result or result->contains(k));
-  auto iter     = RangeContaining(intervals_.begin(), intervals_.end(), k);
+  auto iter     = Containing(k);
   return result = (iter == intervals_.end()) ? nullptr : &iter->first;
 }
 
 template <std::totally_ordered K, std::equality_comparable M>
 M const& interval_map<K, M>::at(key_type const& k) const {
-  auto iter = RangeContaining(intervals_.begin(), intervals_.end(), k);
+  auto iter = Containing(k);
   NTH_REQUIRE((harden), iter != intervals_.end());
   return iter->second;
 }
@@ -265,10 +343,151 @@ std::pair<::nth::interval<K> const, M> const* interval_map<K, M>::mapped_range(
     key_type const& k) const {
   std::pair<interval_type const, mapped_type> const* result;
   NTH_ENSURE((debug), not result or result->first.contains(k));
-  auto iter     = RangeContaining(intervals_.begin(), intervals_.end(), k);
+  auto iter     = Containing(k);
   return result = (iter == intervals_.end()) ? nullptr : &*iter;
 }
 
+template <std::totally_ordered K, std::equality_comparable M>
+void interval_map<K, M>::mapped_values(
+    std::span<key_type const> keys, std::span<mapped_type const*> out) const {
+  NTH_REQUIRE((harden), keys.size() == out.size());
+  NTH_REQUIRE((debug), std::is_sorted(keys.begin(), keys.end()));
+  // The number of entries to step over before searching for the next key
+  // instead.
+  constexpr int MaxSteps = 8;
+  auto iter              = intervals_.begin();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_type const& k = keys[i];
+    for (int steps = 0;
+         iter != intervals_.end() and iter->first.upper_bound() <= k;
+         ++steps) {
+      if (steps == MaxSteps) {
+        iter = intervals_.lower_bound(
+            internal_interval_map::Point<key_type>{k});
+        break;
+      }
+      ++iter;
+    }
+    out[i] = (iter != intervals_.end() and iter->first.lower_bound() <= k)
+                 ? &iter->second
+                 : nullptr;
+  }
+}
+
+// Accumulates assignments of values to intervals of keys and constructs an
+// `interval_map` from them in a single pass. Assignments may be made in any
+// order; where assigned intervals overlap, the result is determined by the
+// order of assignment. Adjacent intervals mapped to equal values are
+// coalesced. Building from `n` assignments with `build()` takes O(n log n)
+// time, in contrast to constructing the map by calling
+// `interval_map::insert_or_assign` for each assignment, each of which may
+// update many entries of the map. Building with `build(merge)` additionally
+// folds over the assignments covering each span between consecutive interval
+// boundaries, taking O(n log n + A) time, where A is the number of such
+// assignments summed over all spans. Deeply nested assignments make A, and
+// hence the build, quadratic in `n`.
+template <std::totally_ordered K, std::equality_comparable M>
+struct interval_map_builder {
+  using key_type      = K;
+  using interval_type = ::nth::interval<key_type>;
+  using mapped_type   = M;
+
+  void reserve(size_t n) { assignments_.reserve(n); }
+
+  // Records that each key in `i` is to be mapped to `v`.
+  template <std::totally_ordered_with<key_type> T,
+            std::convertible_to<mapped_type> V>
+  void insert_or_assign(::nth::interval<T> const& i, V&& v) {
+    if (i.empty()) { return; }
+    assignments_.emplace_back(interval_type(i), std::forward<V>(v));
+  }
+
+  // Returns a map in which each key is mapped to the value it was most
+  // recently assigned.
+  interval_map<K, M> build() && {
+    return sweep([](auto const& active) { return *active.rbegin()->second; });
+  }
+
+  // Returns a map in which each key is mapped to the result of folding `merge`
+  // over the values it was assigned, in the order they were assigned. That
+  // is, a key assigned `v1`, `v2` and `v3` is mapped to
+  // `merge(merge(v1, v2), v3)`. For each span between consecutive interval
+  // boundaries, `merge` is invoked once per assignment covering it beyond the
+  // first.
+  template <std::invocable<mapped_type const&, mapped_type const&> Merge>
+  interval_map<K, M> build(Merge merge) && {
+    return sweep([&](auto const& active) {
+      auto iter          = active.begin();
+      mapped_type result = *iter->second;
+      for (++iter; iter != active.end(); ++iter) {
+        result = merge(std::move(result), *iter->second);
+      }
+      return result;
+    });
+  }
+
+ private:
+  // Visits the boundaries of all assigned intervals in increasing order,
+  // tracking the assignments covering each span between consecutive
+  // boundaries. For each such span covered by at least one assignment,
+  // `resolve` is invoked with those assignments, ordered by when they were
+  // made, to produce the mapped value for the span.
+  template <typename Resolve>
+  interval_map<K, M> sweep(Resolve resolve) {
+    struct boundary {
+      key_type const* key;
+      size_t assignment;
+      bool starts;
+    };
+    std::vector<boundary> boundaries;
+    boundaries.reserve(2 * assignments_.size());
+    for (size_t n = 0; n < assignments_.size(); ++n) {
+      auto const& i = assignments_[n].first;
+      boundaries.push_back({&i.lower_bound(), n, true});
+      boundaries.push_back({&i.upper_bound(), n, false});
+    }
+    std::sort(boundaries.begin(), boundaries.end(),
+              [](boundary const& l, boundary const& r) {
+                return *l.key < *r.key;
+              });
+
+    std::vector<std::pair<interval_type, mapped_type>> spans;
+    std::map<size_t, mapped_type const*> active;
+    key_type const* start = nullptr;
+    for (auto iter = boundaries.begin(); iter != boundaries.end();) {
+      key_type const& k = *iter->key;
+      if (not active.empty()) {
+        mapped_type m = resolve(active);
+        if (not spans.empty() and spans.back().first.upper_bound() == *start and
+            spans.back().second == m) {
+          spans.back().first.set_upper_bound(k);
+        } else {
+          spans.emplace_back(interval_type(*start, k), std::move(m));
+        }
+      }
+      for (; iter != boundaries.end() and not(k < *iter->key); ++iter) {
+        if (iter->starts) {
+          active.emplace(iter->assignment,
+                         &assignments_[iter->assignment].second);
+        } else {
+          active.erase(iter->assignment);
+        }
+      }
+      start = &k;
+    }
+
+    interval_map<K, M> result;
+    for (auto& [i, m] : spans) {
+      result.intervals_.emplace_hint(result.intervals_.end(), std::move(i),
+                                     std::move(m));
+    }
+    assignments_.clear();
+    return result;
+  }
+
+  std::vector<std::pair<interval_type, mapped_type>> assignments_;
+};
+
 }  // namespace nth
 
 template <typename K, typename M>
@@ -1,7 +1,11 @@
 #include "nth/container/interval_map.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
+#include <vector>
 
+#include "nth/test/benchmark.h"
 #include "nth/test/test.h"
 
 namespace nth {
@@ -142,5 +146,228 @@ NTH_TEST("interval_map/mapped_range") {
   NTH_EXPECT(map.mapped_range(8) == nullptr);
 }
 
+NTH_TEST("interval_map/mapped_values") {
+  interval_map<int, std::string> map;
+  map.insert_or_assign(interval(3, 5), "a");
+  map.insert_or_assign(interval(5, 7), "b");
+  map.insert_or_assign(interval(20, 23), "c");
+  for (int i = 0; i < 20; ++i) {
+    map.insert_or_assign(interval(100 + 2 * i, 101 + 2 * i), "d");
+  }
+
+  std::vector<int> keys = {0, 3, 4, 5, 6, 7, 19, 20, 22, 23, 138, 139, 500};
+  std::vector<std::string const*> values(keys.size());
+  map.mapped_values(keys, values);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (map.contains(keys[i])) {
+      NTH_ASSERT(values[i] != nullptr);
+      NTH_EXPECT(*values[i] == map.at(keys[i]));
+    } else {
+      NTH_EXPECT(values[i] == nullptr);
+    }
+  }
+}
+
+NTH_TEST("interval_map/overlapping") {
+  interval_map<int, std::string> map;
+  map.insert_or_assign(interval(3, 5), "a");
+  map.insert_or_assign(interval(5, 7), "b");
+  map.insert_or_assign(interval(20, 23), "c");
+
+  auto values = [&](interval<int> const& i) {
+    std::vector<std::string> result;
+    for (auto const& [range, value] : map.overlapping(i)) {
+      result.push_back(value);
+    }
+    return result;
+  };
+  NTH_EXPECT(values(interval(0, 3)).empty());
+  NTH_EXPECT(values(interval(4, 4)).empty());
+  NTH_EXPECT(values(interval(0, 4)) >>= ElementsAreSequentially("a"));
+  NTH_EXPECT(values(interval(4, 6)) >>= ElementsAreSequentially("a", "b"));
+  NTH_EXPECT(values(interval(5, 20)) >>= ElementsAreSequentially("b"));
+  NTH_EXPECT(values(interval(5, 21)) >>= ElementsAreSequentially("b", "c"));
+  NTH_EXPECT(values(interval(0, 100)) >>=
+             ElementsAreSequentially("a", "b", "c"));
+  NTH_EXPECT(values(interval(23, 100)).empty());
+}
+
+NTH_TEST("interval_map/benchmark/lookup", size_t count) {
+  interval_map<uint64_t, uint64_t> map;
+  for (uint64_t i = 0; i < count; ++i) {
+    map.insert_or_assign(interval(i * 1024, i * 1024 + 512), i);
+  }
+  std::vector<uint64_t> keys;
+  for (uint64_t i = 0; i < 4096; ++i) {
+    keys.push_back((i * 0x9e3779b97f4a7c15) % (count * 1024));
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<uint64_t const*> values(keys.size());
+  NTH_MEASURE() {
+    NTH_TIME("mapped_range") {
+      for (uint64_t k : keys) {
+        auto const* entry = map.mapped_range(k);
+        nth::DoNotOptimize(entry);
+      }
+    }
+    NTH_TIME("mapped_values") {
+      map.mapped_values(keys, values);
+      nth::DoNotOptimize(values);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("interval_map/benchmark/lookup") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 18;
+}
+
+NTH_TEST("interval_map/insert_or_assign/split") {
+  interval_map<int, std::string> map;
+  map.insert_or_assign(interval(10, 20), "a");
+  map.insert_or_assign(interval(13, 15), "b");
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(10, 13), "a"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(13, 15), "b"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(15, 20), "a")));
+
+  map.insert_or_assign(interval(12, 16), "a");
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(10, 20), "a")));
+
+  map.insert_or_assign(interval(15, 15), "c");
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(10, 20), "a")));
+}
+
+NTH_TEST("interval_map/insert_or_assign/range") {
+  interval_map<int, std::string> map;
+  map.insert_or_assign(interval(0, 10), "a");
+  std::vector<std::pair<interval<int>, std::string>> assignments = {
+      {interval(20, 30), "b"},
+      {interval(5, 25), "c"},
+      {interval(8, 9), "a"},
+  };
+  map.insert_or_assign(assignments.begin(), assignments.end());
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(0, 5), "a"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(5, 8), "c"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(8, 9), "a"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(9, 25), "c"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(25, 30), "b")));
+}
+
+NTH_TEST("interval_map/insert_or_assign/small-range") {
+  interval_map<int, int> map, expected;
+  for (int i = 0; i < 100; ++i) {
+    map.insert_or_assign(interval(10 * i, 10 * i + 5), i);
+    expected.insert_or_assign(interval(10 * i, 10 * i + 5), i);
+  }
+  std::vector<std::pair<interval<int>, int>> assignments = {
+      {interval(3, 23), -1},
+      {interval(500, 700), -2},
+      {interval(8, 9), 1},
+  };
+  map.insert_or_assign(assignments.begin(), assignments.end());
+  for (auto const& [i, v] : assignments) { expected.insert_or_assign(i, v); }
+  NTH_EXPECT(map.mapped_intervals().size() ==
+             expected.mapped_intervals().size());
+  NTH_EXPECT(std::equal(map.mapped_intervals().begin(),
+                        map.mapped_intervals().end(),
+                        expected.mapped_intervals().begin()));
+}
+
+NTH_TEST("interval_map_builder/last-writer-wins") {
+  interval_map_builder<int, std::string> builder;
+  builder.insert_or_assign(interval(20, 30), "b");
+  builder.insert_or_assign(interval(0, 10), "a");
+  builder.insert_or_assign(interval(5, 25), "a");
+  builder.insert_or_assign(interval(28, 40), "c");
+  builder.insert_or_assign(interval(50, 50), "d");
+  auto map = std::move(builder).build();
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(0, 25), "a"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(25, 28), "b"),
+                 std::pair<nth::interval<int> const, std::string>(
+                     nth::interval(28, 40), "c")));
+}
+
+NTH_TEST("interval_map_builder/merge") {
+  interval_map_builder<int, int> builder;
+  builder.insert_or_assign(interval(0, 10), 1);
+  builder.insert_or_assign(interval(5, 15), 2);
+  builder.insert_or_assign(interval(10, 20), -2);
+  auto map = std::move(builder).build([](int l, int r) { return l + r; });
+  NTH_EXPECT(map.mapped_intervals() >>= ElementsAreSequentially(
+                 std::pair<nth::interval<int> const, int>(
+                     nth::interval(0, 5), 1),
+                 std::pair<nth::interval<int> const, int>(
+                     nth::interval(5, 10), 3),
+                 std::pair<nth::interval<int> const, int>(
+                     nth::interval(10, 15), 0),
+                 std::pair<nth::interval<int> const, int>(
+                     nth::interval(15, 20), -2)));
+}
+
+NTH_TEST("interval_map_builder/deep-overlap") {
+  // Each assignment is nested strictly inside all those before it.
+  constexpr int Depth = 200;
+  interval_map_builder<int, int> last_writer, merging;
+  for (int i = 0; i < Depth; ++i) {
+    last_writer.insert_or_assign(interval(i, 2 * Depth - i), i);
+    merging.insert_or_assign(interval(i, 2 * Depth - i), 1);
+  }
+  auto innermost = std::move(last_writer).build();
+  auto depth     = std::move(merging).build([](int l, int r) { return l + r; });
+
+  NTH_EXPECT(innermost.mapped_intervals().size() == size_t{2 * Depth - 1});
+  NTH_EXPECT(depth.mapped_intervals().size() == size_t{2 * Depth - 1});
+  for (int k = 0; k < 2 * Depth; ++k) {
+    int nesting = std::min(k, 2 * Depth - 1 - k);
+    NTH_EXPECT(innermost.at(k) == nesting);
+    NTH_EXPECT(depth.at(k) == nesting + 1);
+  }
+  NTH_EXPECT(not depth.contains(2 * Depth));
+}
+
+NTH_TEST("interval_map/benchmark/build", size_t count) {
+  std::vector<std::pair<interval<uint64_t>, uint64_t>> assignments;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t lower = (i * 0x9e3779b97f4a7c15) >> 40;
+    assignments.emplace_back(interval(lower, lower + 4096), i % 4);
+  }
+  NTH_MEASURE() {
+    NTH_TIME("insert_or_assign") {
+      interval_map<uint64_t, uint64_t> map;
+      for (auto const& [i, v] : assignments) { map.insert_or_assign(i, v); }
+      nth::DoNotOptimize(map);
+    }
+    NTH_TIME("builder") {
+      interval_map_builder<uint64_t, uint64_t> builder;
+      builder.reserve(assignments.size());
+      for (auto const& [i, v] : assignments) { builder.insert_or_assign(i, v); }
+      auto map = std::move(builder).build();
+      nth::DoNotOptimize(map);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("interval_map/benchmark/build") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 16;
+}
+
 }  // namespace
 }  // namespace nth
@@ -3,13 +3,22 @@
 
 #include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
 #include <span>
+#include <thread>
 #include <vector>
 
 #include "nth/container/interval.h"
 #include "nth/debug/debug.h"
 
 namespace nth {
+namespace internal_interval_set {
+
+struct algebra;
+
+}  // namespace internal_interval_set
 
 // Represents a set of elements of type `T` by storing the half-open interval
 // consisting of values greater than or equal to the lower bound and less than
@@ -23,7 +32,7 @@ struct interval_set {
 
   template <std::convertible_to<T> U>
   explicit constexpr interval_set(interval<U> const& interval)
-      : intervals_(interval) {}
+      : intervals_{interval_type(interval)} {}
 
   template <std::convertible_to<T> U>
   explicit constexpr interval_set(interval<U>&& interval) {
@@ -62,6 +71,20 @@ struct interval_set {
     insert_hint(intervals_.begin(), i);
   }
 
+  // Inserts each interval in the range [`b`, `e`). Rather than inserting
+  // intervals one at a time, the new intervals are appended, sorted, and merged
+  // with the existing intervals in a single pass, so inserting `n` intervals
+  // into a set of `m` intervals takes O(n log n + m) time regardless of the
+  // order in which they appear.
+  template <std::input_iterator Iter, std::sentinel_for<Iter> S>
+  void insert(Iter b, S e);
+
+  // Inserts each interval in the range `r`, as by `insert(b, e)` above.
+  template <std::ranges::input_range R>
+  void insert_range(R&& r) {
+    insert(std::ranges::begin(r), std::ranges::end(r));
+  }
+
   template <std::totally_ordered_with<T> U>
   interval_set& operator+=(interval_set<U> const& rhs);
 
@@ -102,11 +125,17 @@ struct interval_set {
   }
 
  private:
+  friend internal_interval_set::algebra;
+
   using iterator = typename std::vector<interval_type>::iterator;
 
   template <std::totally_ordered_with<T> U>
   iterator insert_hint(iterator iter, interval<U> const& i);
 
+  // Merges each interval into its predecessor if the two overlap or abut.
+  // Requires that `intervals_` be sorted by lower bound.
+  void coalesce();
+
   std::vector<interval_type> intervals_;
 };
 
@@ -195,6 +224,41 @@ typename interval_set<T>::iterator interval_set<T>::insert_hint(
   return lower_iter;
 }
 
+template <std::totally_ordered T>
+template <std::input_iterator Iter, std::sentinel_for<Iter> S>
+void interval_set<T>::insert(Iter b, S e) {
+  if constexpr (std::forward_iterator<Iter>) {
+    intervals_.reserve(intervals_.size() +
+                       static_cast<size_t>(std::ranges::distance(b, e)));
+  }
+  auto by_lower_bound = [](interval_type const& l, interval_type const& r) {
+    return l.lower_bound() < r.lower_bound();
+  };
+  size_t existing = intervals_.size();
+  for (; b != e; ++b) { intervals_.emplace_back(*b); }
+  auto mid = intervals_.begin() + existing;
+  std::sort(mid, intervals_.end(), by_lower_bound);
+  std::inplace_merge(intervals_.begin(), mid, intervals_.end(),
+                     by_lower_bound);
+  coalesce();
+}
+
+template <std::totally_ordered T>
+void interval_set<T>::coalesce() {
+  if (intervals_.empty()) { return; }
+  auto out = intervals_.begin();
+  for (auto iter = std::next(out); iter != intervals_.end(); ++iter) {
+    if (iter->lower_bound() <= out->upper_bound()) {
+      if (out->upper_bound() < iter->upper_bound()) {
+        out->set_upper_bound(std::move(*iter).upper_bound());
+      }
+    } else if (++out != iter) {
+      *out = std::move(*iter);
+    }
+  }
+  intervals_.erase(std::next(out), intervals_.end());
+}
+
 template <std::totally_ordered T>
 template <std::totally_ordered_with<T> U>
 interval_set<T>& interval_set<T>::operator+=(interval_set<U> const& rhs) {
@@ -226,6 +290,193 @@ interval_set<T> Union(interval_set<T>&& lhs, interval_set<T>&& rhs) {
   return std::move(lhs) + std::move(rhs);
 }
 
+namespace internal_interval_set {
+
+// Implements set operations as a single sweep over the boundaries of the
+// intervals of both operands, in increasing order. At each boundary, `keep` is
+// invoked with whether the sweep is within an interval of each operand and
+// reports whether the result contains those elements. Empty intervals contain
+// no elements and are ignored.
+struct algebra {
+  // The fewest intervals of the larger operand worth merging on a thread of
+  // their own; smaller pieces cost more to spawn a thread for than to merge.
+  static constexpr size_t min_grain = 1024;
+
+  template <typename T, typename Keep>
+  static void merge(std::span<interval<T> const> a,
+                    std::span<interval<T> const> b, Keep keep,
+                    std::vector<interval<T>>& out) {
+    auto skip_empty = [](std::span<interval<T> const> s, size_t& n) {
+      while (n < s.size() and s[n].empty()) { ++n; }
+    };
+    // The next boundary of `s` given that the sweep is within `s[n]` if and
+    // only if `in` is true, or null if there are no further boundaries.
+    auto next = [](std::span<interval<T> const> s, size_t n,
+                   bool in) -> T const* {
+      if (n == s.size()) { return nullptr; }
+      return in ? &s[n].upper_bound() : &s[n].lower_bound();
+    };
+
+    size_t i = 0, j = 0;
+    bool in_a = false, in_b = false;
+    skip_empty(a, i);
+    skip_empty(b, j);
+    T const* start = nullptr;
+    while (true) {
+      T const* next_a = next(a, i, in_a);
+      T const* next_b = next(b, j, in_b);
+      if (not next_a and not next_b) { break; }
+      T const* x =
+          (not next_b or (next_a and *next_a <= *next_b)) ? next_a : next_b;
+
+      bool kept = keep(in_a, in_b);
+      if (next_a and not(*x < *next_a)) {
+        if (std::exchange(in_a, not in_a)) { skip_empty(a, ++i); }
+      }
+      if (next_b and not(*x < *next_b)) {
+        if (std::exchange(in_b, not in_b)) { skip_empty(b, ++j); }
+      }
+      bool keeping = keep(in_a, in_b);
+
+      if (not kept and keeping) {
+        start = x;
+      } else if (kept and not keeping) {
+        out.emplace_back(*start, *x);
+      }
+    }
+  }
+
+  template <typename T, typename Keep>
+  static interval_set<T> combine(std::span<interval<T> const> a,
+                                 std::span<interval<T> const> b, Keep keep,
+                                 size_t thread_count) {
+    interval_set<T> result;
+    std::span<interval<T> const> larger = a.size() < b.size() ? b : a;
+    thread_count = std::min(thread_count, larger.size() / min_grain);
+    if (thread_count <= 1) {
+      result.intervals_.reserve(a.size() + b.size());
+      merge(a, b, keep, result.intervals_);
+      return result;
+    }
+
+    // Split the domain at evenly spaced lower bounds of the larger operand.
+    // Each piece is computed independently from the intervals of both operands
+    // clipped to that piece, and the pieces are then concatenated.
+    std::vector<T const*> splits;
+    splits.reserve(thread_count + 1);
+    splits.push_back(nullptr);
+    for (size_t t = 1; t < thread_count; ++t) {
+      splits.push_back(&larger[t * larger.size() / thread_count].lower_bound());
+    }
+    splits.push_back(nullptr);
+
+    std::vector<std::vector<interval<T>>> pieces(thread_count);
+    auto compute_piece = [&](size_t t) {
+      std::vector<interval<T>> clipped_a = clip(a, splits[t], splits[t + 1]);
+      std::vector<interval<T>> clipped_b = clip(b, splits[t], splits[t + 1]);
+      pieces[t].reserve(clipped_a.size() + clipped_b.size());
+      merge<T>(clipped_a, clipped_b, keep, pieces[t]);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t t = 1; t < thread_count; ++t) {
+      threads.emplace_back(compute_piece, t);
+    }
+    compute_piece(0);
+    for (auto& thread : threads) { thread.join(); }
+
+    size_t total = 0;
+    for (auto const& piece : pieces) { total += piece.size(); }
+    result.intervals_.reserve(total);
+    for (auto& piece : pieces) {
+      for (auto& i : piece) {
+        if (not result.intervals_.empty() and
+            result.intervals_.back().upper_bound() == i.lower_bound()) {
+          result.intervals_.back().set_upper_bound(
+              std::move(i).upper_bound());
+        } else {
+          result.intervals_.push_back(std::move(i));
+        }
+      }
+    }
+    return result;
+  }
+
+  // Returns the intervals of `s` restricted to those elements at least `*lo`
+  // and less than `*hi`. A null bound imposes no restriction.
+  template <typename T>
+  static std::vector<interval<T>> clip(std::span<interval<T> const> s,
+                                       T const* lo, T const* hi) {
+    auto b = lo ? std::partition_point(s.begin(), s.end(),
+                                       [&](interval<T> const& i) {
+                                         return i.upper_bound() <= *lo;
+                                       })
+                : s.begin();
+    auto e = hi ? std::partition_point(b, s.end(),
+                                       [&](interval<T> const& i) {
+                                         return i.lower_bound() < *hi;
+                                       })
+                : s.end();
+    std::vector<interval<T>> result(b, e);
+    if (result.empty()) { return result; }
+    if (lo and result.front().lower_bound() < *lo) {
+      result.front().set_lower_bound(*lo);
+    }
+    if (hi and *hi < result.back().upper_bound()) {
+      result.back().set_upper_bound(*hi);
+    }
+    return result;
+  }
+};
+
+}  // namespace internal_interval_set
+
+// The set operations below are each computed in a single linear merge of the
+// sorted intervals of their operands. If `thread_count` is greater than one,
+// the domain is divided into up to that many pieces, each merged on its own
+// thread. Fewer threads are used when the operands are too small for each
+// piece to be worth a thread.
+
+// Returns the set of elements contained in both `lhs` and `rhs`.
+template <std::totally_ordered T>
+interval_set<T> Intersection(interval_set<T> const& lhs,
+                             interval_set<T> const& rhs,
+                             size_t thread_count = 1) {
+  return internal_interval_set::algebra::combine(
+      lhs.intervals(), rhs.intervals(),
+      [](bool l, bool r) { return l and r; }, thread_count);
+}
+
+// Returns the set of elements contained in `lhs` but not in `rhs`.
+template <std::totally_ordered T>
+interval_set<T> Difference(interval_set<T> const& lhs,
+                           interval_set<T> const& rhs,
+                           size_t thread_count = 1) {
+  return internal_interval_set::algebra::combine(
+      lhs.intervals(), rhs.intervals(),
+      [](bool l, bool r) { return l and not r; }, thread_count);
+}
+
+// Returns the set of elements contained in exactly one of `lhs` and `rhs`.
+template <std::totally_ordered T>
+interval_set<T> SymmetricDifference(interval_set<T> const& lhs,
+                                    interval_set<T> const& rhs,
+                                    size_t thread_count = 1) {
+  return internal_interval_set::algebra::combine(
+      lhs.intervals(), rhs.intervals(), [](bool l, bool r) { return l != r; },
+      thread_count);
+}
+
+// Returns the set of elements contained in `bounds` but not in `set`.
+template <std::totally_ordered T>
+interval_set<T> Complement(interval_set<T> const& set,
+                           interval<T> const& bounds,
+                           size_t thread_count = 1) {
+  return internal_interval_set::algebra::combine(
+      std::span<interval<T> const>(&bounds, 1), set.intervals(),
+      [](bool l, bool r) { return l and not r; }, thread_count);
+}
+
 }  // namespace nth
 
 template <typename T>
@@ -1,7 +1,10 @@
 #include "nth/container/interval_set.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
+#include "nth/test/benchmark.h"
 #include "nth/test/test.h"
 
 namespace nth {
@@ -139,5 +142,145 @@ NTH_TEST("interval_set/union") {
 }
 #endif
 
+NTH_TEST("interval_set/bulk-insertion") {
+  interval_set<int> set;
+  set.insert(interval(0, 2));
+  std::vector<interval<int>> intervals = {
+      interval(20, 30), interval(3, 5), interval(5, 7),
+      interval(40, 41), interval(25, 35), interval(1, 3)};
+  set.insert_range(intervals);
+  NTH_EXPECT(set.intervals() >>= ElementsAreSequentially(
+                 interval(0, 7), interval(20, 35), interval(40, 41)));
+
+  set.insert(intervals.begin(), intervals.begin());
+  NTH_EXPECT(set.intervals() >>= ElementsAreSequentially(
+                 interval(0, 7), interval(20, 35), interval(40, 41)));
+}
+
+NTH_TEST("interval_set/bulk-insertion/matches-insert") {
+  std::vector<interval<int>> intervals;
+  for (int i = 0; i < 1000; ++i) {
+    int lower = (i * 7919) % 5000;
+    intervals.push_back(interval(lower, lower + i % 17));
+  }
+  interval_set<int> one_at_a_time, bulk;
+  for (auto const& i : intervals) { one_at_a_time.insert(i); }
+  bulk.insert_range(intervals);
+  NTH_ASSERT(one_at_a_time.intervals().size() == bulk.intervals().size());
+  for (size_t i = 0; i < bulk.intervals().size(); ++i) {
+    NTH_EXPECT(one_at_a_time.intervals()[i] == bulk.intervals()[i]);
+  }
+}
+
+NTH_TEST("interval_set/benchmark/build", size_t count) {
+  std::vector<interval<uint64_t>> intervals;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t lower = (i * 0x9e3779b97f4a7c15) >> 24;
+    intervals.push_back(interval(lower, lower + 256));
+  }
+  NTH_MEASURE() {
+    NTH_TIME("one-at-a-time") {
+      interval_set<uint64_t> set;
+      for (auto const& i : intervals) { set.insert(i); }
+      nth::DoNotOptimize(set);
+    }
+    NTH_TIME("bulk") {
+      interval_set<uint64_t> set;
+      set.insert_range(intervals);
+      nth::DoNotOptimize(set);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("interval_set/benchmark/build") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 14;
+}
+
+NTH_TEST("interval_set/algebra/basic", size_t thread_count) {
+  interval_set<int> a, b;
+  a.insert(interval(0, 10));
+  a.insert(interval(20, 30));
+  a.insert(interval(40, 50));
+  b.insert(interval(5, 25));
+  b.insert(interval(45, 60));
+
+  NTH_EXPECT(Intersection(a, b, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(5, 10), interval(20, 25),
+                                     interval(45, 50)));
+  NTH_EXPECT(Difference(a, b, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(0, 5), interval(25, 30),
+                                     interval(40, 45)));
+  NTH_EXPECT(Difference(b, a, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(10, 20), interval(50, 60)));
+  NTH_EXPECT(SymmetricDifference(a, b, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(0, 5), interval(10, 20),
+                                     interval(25, 30), interval(40, 45),
+                                     interval(50, 60)));
+  NTH_EXPECT(Complement(a, interval(-5, 45), thread_count).intervals() >>=
+             ElementsAreSequentially(interval(-5, 0), interval(10, 20),
+                                     interval(30, 40)));
+}
+
+NTH_TEST("interval_set/algebra/empty", size_t thread_count) {
+  interval_set<int> a, empty;
+  a.insert(interval(0, 10));
+  NTH_EXPECT(Intersection(a, empty, thread_count).empty());
+  NTH_EXPECT(Difference(empty, a, thread_count).empty());
+  NTH_EXPECT(Difference(a, empty, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(0, 10)));
+  NTH_EXPECT(SymmetricDifference(empty, a, thread_count).intervals() >>=
+             ElementsAreSequentially(interval(0, 10)));
+  NTH_EXPECT(Complement(empty, interval(3, 4), thread_count).intervals() >>=
+             ElementsAreSequentially(interval(3, 4)));
+  NTH_EXPECT(Complement(a, interval(3, 4), thread_count).empty());
+}
+
+NTH_TEST("interval_set/parallel-algebra") {
+  interval_set<int> a, b;
+  for (int i = 0; i < 20000; ++i) {
+    int lower = (i * 7919) % 400000;
+    a.insert(interval(lower, lower + i % 23));
+    b.insert(interval(lower + 11, lower + 11 + i % 29));
+  }
+  auto sequential = SymmetricDifference(a, b);
+  for (size_t thread_count : {2, 3, 8}) {
+    auto parallel = SymmetricDifference(a, b, thread_count);
+    NTH_ASSERT(parallel.intervals().size() == sequential.intervals().size());
+    for (size_t i = 0; i < parallel.intervals().size(); ++i) {
+      NTH_EXPECT(parallel.intervals()[i] == sequential.intervals()[i]);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("interval_set/algebra/*") {
+  for (size_t thread_count : {1, 2, 4}) { co_yield thread_count; }
+}
+
+NTH_TEST("interval_set/benchmark/algebra", size_t thread_count) {
+  std::vector<interval<uint64_t>> lhs, rhs;
+  for (uint64_t i = 0; i < (1 << 20); ++i) {
+    lhs.push_back(interval(i * 1024, i * 1024 + 512));
+    rhs.push_back(interval(i * 1024 + 256, i * 1024 + 768));
+  }
+  interval_set<uint64_t> a, b;
+  a.insert_range(lhs);
+  b.insert_range(rhs);
+  NTH_MEASURE() {
+    NTH_TIME("intersection") {
+      auto result = Intersection(a, b, thread_count);
+      nth::DoNotOptimize(result);
+    }
+    NTH_TIME("symmetric-difference") {
+      auto result = SymmetricDifference(a, b, thread_count);
+      nth::DoNotOptimize(result);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("interval_set/benchmark/algebra") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
 }  // namespace
 }  // namespace nth
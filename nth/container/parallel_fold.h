@@ -0,0 +1,213 @@
+#ifndef NTH_CONTAINER_PARALLEL_FOLD_H
+#define NTH_CONTAINER_PARALLEL_FOLD_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nth/container/flat_forest.h"
+
+namespace nth {
+
+struct parallel_fold_options {
+  // The number of threads on which to evaluate the fold, including the calling
+  // thread.
+  size_t thread_count = 1;
+
+  // Subtrees with at most this many nodes are folded sequentially, as a single
+  // unit of work. Larger values reduce scheduling overhead, and smaller values
+  // expose more parallelism.
+  size_t grain_size = 4096;
+};
+
+// The results of `parallel_fold`, holding one result for each node of the
+// forest which was folded.
+template <typename Forest, typename R>
+struct fold_result {
+  using index_type = typename Forest::index_type;
+
+  // Returns the result computed for the node referred to by `index`.
+  R const &operator[](index_type index) const {
+    return values_[internal_flat_forest::access::position(index)];
+  }
+
+  // Returns the number of results, which is the number of nodes in the forest.
+  size_t size() const { return size_; }
+
+  // Returns the results for all nodes in post-order.
+  std::span<R const> values() const { return std::span(values_.get(), size_); }
+
+ private:
+  template <typename R2, typename T, flat_forest_options Options,
+            typename Combine>
+  friend fold_result<flat_forest<T, Options>, R2> parallel_fold(
+      flat_forest<T, Options> const &, Combine, parallel_fold_options);
+
+  explicit fold_result(std::unique_ptr<R[]> values, size_t size)
+      : values_(std::move(values)), size_(size) {}
+
+  // Not a `std::vector`, so that results for distinct nodes never share
+  // storage (as they would in a `std::vector<bool>`) and may be written by
+  // different threads.
+  std::unique_ptr<R[]> values_;
+  size_t size_;
+};
+
+namespace internal_parallel_fold {
+
+// A range over the results computed for the children of a node, in the same
+// order as the node's `children()`.
+template <typename Forest, typename R>
+struct child_results {
+  struct iterator {
+    using value_type      = R;
+    using difference_type = ptrdiff_t;
+
+    R const &operator*() const { return results_[position_]; }
+
+    iterator &operator++() {
+      size_t size = internal_flat_forest::access::subtree_size(*forest_,
+                                                               position_);
+      remaining_ -= size;
+      position_ -= size;
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(iterator const &it, std::default_sentinel_t) {
+      return it.remaining_ == 0;
+    }
+
+   private:
+    friend child_results;
+    explicit iterator(Forest const *forest, R const *results, size_t position,
+                      size_t remaining)
+        : forest_(forest),
+          results_(results),
+          position_(position),
+          remaining_(remaining) {}
+
+    Forest const *forest_;
+    R const *results_;
+    size_t position_;
+    size_t remaining_;
+  };
+
+  explicit child_results(Forest const &forest, R const *results,
+                         size_t position)
+      : forest_(&forest), results_(results), position_(position) {}
+
+  iterator begin() const {
+    return iterator(
+        forest_, results_, position_ - 1,
+        internal_flat_forest::access::subtree_size(*forest_, position_) - 1);
+  }
+  std::default_sentinel_t end() const { return std::default_sentinel; }
+
+ private:
+  Forest const *forest_;
+  R const *results_;
+  size_t position_;
+};
+
+}  // namespace internal_parallel_fold
+
+// Evaluates `combine` at every node of `forest`, bottom-up, returning the
+// result for each node. At each node, `combine(value, children)` is invoked
+// with the node's value and a range over the results already computed for its
+// children (in the same order as `children()`), and must return a value
+// convertible to `R`.
+//
+// Because nodes are stored in post-order, each subtree occupies a contiguous
+// range of the forest. Subtrees with at most `options.grain_size` nodes are
+// each folded sequentially as a single unit of work, distributed amongst
+// `options.thread_count` threads. The remaining nodes, each of which is the
+// root of a larger subtree, are evaluated on the calling thread once all work
+// below them has completed. `combine` may therefore be invoked concurrently
+// for nodes in distinct subtrees, and must not throw.
+template <typename R, typename T, flat_forest_options Options,
+          typename Combine>
+fold_result<flat_forest<T, Options>, R> parallel_fold(
+    flat_forest<T, Options> const &forest, Combine combine,
+    parallel_fold_options options = {}) {
+  using access  = internal_flat_forest::access;
+  using results = internal_parallel_fold::child_results<flat_forest<T, Options>,
+                                                        R>;
+  static_assert(std::default_initializable<R>);
+
+  size_t n = forest.size();
+  auto values = std::make_unique<R[]>(n);
+  auto fold = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      values[i] = combine(access::value(forest, i),
+                          results(forest, values.get(), i));
+    }
+  };
+
+  if (options.thread_count <= 1 or n <= options.grain_size) {
+    fold(0, n);
+    return fold_result<flat_forest<T, Options>, R>(std::move(values), n);
+  }
+
+  // Walk down from the roots, splitting off every subtree small enough to be a
+  // single unit of work. The roots of the remaining subtrees form the spine.
+  std::vector<size_t> tasks, spine, pending;
+  for (size_t end = n; end > 0; end -= access::subtree_size(forest, end - 1)) {
+    pending.push_back(end - 1);
+  }
+  while (not pending.empty()) {
+    size_t root = pending.back();
+    pending.pop_back();
+    size_t size = access::subtree_size(forest, root);
+    if (size <= options.grain_size) {
+      tasks.push_back(root);
+      continue;
+    }
+    spine.push_back(root);
+    size_t child = root - 1;
+    for (size_t remaining = size - 1; remaining > 0;) {
+      pending.push_back(child);
+      size_t child_size = access::subtree_size(forest, child);
+      remaining -= child_size;
+      child -= child_size;
+    }
+  }
+
+  // Hand out the largest subtrees first so that no thread is left with a large
+  // subtree after the others have finished.
+  std::sort(tasks.begin(), tasks.end(), [&](size_t lhs, size_t rhs) {
+    return access::subtree_size(forest, lhs) >
+           access::subtree_size(forest, rhs);
+  });
+  std::atomic<size_t> next = 0;
+  auto work = [&] {
+    for (size_t t = next.fetch_add(1, std::memory_order_relaxed);
+         t < tasks.size(); t = next.fetch_add(1, std::memory_order_relaxed)) {
+      size_t root = tasks[t];
+      fold(root + 1 - access::subtree_size(forest, root), root + 1);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(options.thread_count - 1);
+  for (size_t t = 1; t < options.thread_count; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) { thread.join(); }
+
+  // Every child of a spine node precedes it in post-order.
+  std::sort(spine.begin(), spine.end());
+  for (size_t root : spine) { fold(root, root + 1); }
+  return fold_result<flat_forest<T, Options>, R>(std::move(values), n);
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_PARALLEL_FOLD_H
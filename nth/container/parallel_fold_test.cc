@@ -0,0 +1,150 @@
+#include "nth/container/parallel_fold.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "nth/container/flat_forest.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+// Returns a forest of `root_count` trees, each node of which has between zero
+// and `max_children` children, down to a depth of `depth`. Values are the
+// positions of the nodes. The recursive helper returns the first node appended
+// for each subtree, from which its root may be appended as an ancestor.
+flat_forest<uint64_t> MakeForest(size_t root_count, size_t depth,
+                                 size_t max_children) {
+  flat_forest<uint64_t> f;
+  uint64_t state = 1;
+  auto append    = [&](auto &self,
+                    size_t d) -> flat_forest<uint64_t>::index_type {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    size_t children = d == 0 ? 0 : (state >> 33) % (max_children + 1);
+    std::optional<flat_forest<uint64_t>::index_type> first;
+    for (size_t c = 0; c < children; ++c) {
+      auto child = self(self, d - 1);
+      if (not first) { first = child; }
+    }
+    uint64_t value = f.size();
+    if (not first) { return f.append_leaf(value); }
+    f.append_ancestor(*first, value);
+    return *first;
+  };
+  for (size_t r = 0; r < root_count; ++r) { append(append, depth); }
+  return f;
+}
+
+uint64_t SubtreeSum(uint64_t value, auto const &children) {
+  for (uint64_t child : children) { value += child; }
+  return value;
+}
+
+NTH_TEST("parallel_fold/empty") {
+  flat_forest<uint64_t> f;
+  auto result = parallel_fold<uint64_t>(
+      f,
+      [](uint64_t v, auto const &children) { return SubtreeSum(v, children); },
+      {.thread_count = 4});
+  NTH_EXPECT(result.size() == 0u);
+}
+
+NTH_TEST("parallel_fold/children") {
+  flat_forest<uint64_t> f;
+  auto a  = f.append_leaf(1);
+  auto b  = f.append_leaf(2);
+  auto ab = f.append_ancestor(a, 3);
+  auto c  = f.append_leaf(4);
+  auto r  = f.append_ancestor(a, 5);
+
+  // Records the number of children, and the order in which their results are
+  // presented.
+  auto result = parallel_fold<std::vector<uint64_t>>(
+      f, [](uint64_t v, auto const &children) {
+        std::vector<uint64_t> seen = {v};
+        for (auto const &child : children) { seen.push_back(child[0]); }
+        return seen;
+      });
+  NTH_EXPECT(result[a] >>= debug::ElementsAreSequentially(uint64_t{1}));
+  NTH_EXPECT(result[b] >>= debug::ElementsAreSequentially(uint64_t{2}));
+  NTH_EXPECT(result[ab] >>= debug::ElementsAreSequentially(
+                 uint64_t{3}, uint64_t{2}, uint64_t{1}));
+  NTH_EXPECT(result[c] >>= debug::ElementsAreSequentially(uint64_t{4}));
+  NTH_EXPECT(result[r] >>= debug::ElementsAreSequentially(
+                 uint64_t{5}, uint64_t{4}, uint64_t{3}));
+}
+
+NTH_TEST("parallel_fold/matches-sequential", size_t thread_count,
+         size_t grain_size) {
+  auto f = MakeForest(4, 8, 4);
+  auto combine = [](uint64_t v, auto const &children) {
+    return SubtreeSum(v, children);
+  };
+  auto sequential = parallel_fold<uint64_t>(f, combine);
+  auto parallel   = parallel_fold<uint64_t>(
+      f, combine, {.thread_count = thread_count, .grain_size = grain_size});
+  NTH_ASSERT(parallel.size() == f.size());
+  for (size_t i = 0; i < f.size(); ++i) {
+    NTH_ASSERT(parallel.values()[i] == sequential.values()[i]);
+  }
+
+  // Each result is the sum of the positions of the nodes in its subtree.
+  auto roots = f.roots();
+  for (auto root = roots.begin(); root != roots.end(); ++root) {
+    uint64_t sum = 0;
+    for (uint64_t v : root.subtree(post_order)) { sum += v; }
+    NTH_EXPECT(parallel.values()[*root] == sum);
+  }
+}
+
+NTH_INVOKE_TEST("parallel_fold/matches-sequential") {
+  for (size_t thread_count : {1, 2, 4, 8}) {
+    for (size_t grain_size : {0, 1, 16, 1024}) {
+      co_yield nth::TestArguments{thread_count, grain_size};
+    }
+  }
+}
+
+NTH_TEST("parallel_fold/bool") {
+  // Results for adjacent nodes may be written by different threads, which
+  // would race if they shared storage.
+  auto f      = MakeForest(64, 6, 3);
+  auto result = parallel_fold<bool>(
+      f,
+      [](uint64_t v, auto const &children) {
+        bool odd = v % 2 == 1;
+        for (bool child : children) { odd = odd or child; }
+        return odd;
+      },
+      {.thread_count = 4, .grain_size = 1});
+  size_t count = 0;
+  for (bool b : result.values()) { count += b ? 1 : 0; }
+  NTH_EXPECT(count >= f.size() / 2);
+}
+
+NTH_TEST("parallel_fold/benchmark/subtree-sum", size_t thread_count) {
+  auto f = MakeForest(64, 16, 3);
+  NTH_MEASURE() {
+    NTH_TIME("parallel_fold") {
+      auto result = parallel_fold<uint64_t>(
+          f,
+          [](uint64_t v, auto const &children) {
+            // Simulate a more expensive per-node computation.
+            for (int i = 0; i < 64; ++i) { v = v * 31 + i; }
+            return SubtreeSum(v, children);
+          },
+          {.thread_count = thread_count});
+      nth::DoNotOptimize(result);
+    }
+  }
+}
+
+NTH_INVOKE_TEST("parallel_fold/benchmark/subtree-sum") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+}  // namespace
+}  // namespace nth
@@ -0,0 +1,340 @@
+#ifndef NTH_CONTAINER_PERSISTENT_INTERVAL_MAP_H
+#define NTH_CONTAINER_PERSISTENT_INTERVAL_MAP_H
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "nth/container/interval.h"
+#include "nth/debug/debug.h"
+
+namespace nth {
+namespace internal_persistent_interval_map {
+
+// A node of an immutable treap ordered by the lower bounds of disjoint
+// intervals. Modifications copy the path from the root to the modified nodes
+// and share every other subtree with the previous version.
+template <typename K, typename M>
+struct node {
+  using pointer = std::shared_ptr<node const>;
+
+  static pointer make(interval<K> key, M value, uint64_t priority,
+                      pointer left, pointer right) {
+    size_t size = 1 + (left ? left->size : 0) + (right ? right->size : 0);
+    return std::make_shared<node const>(
+        node{.key      = std::move(key),
+             .value    = std::move(value),
+             .priority = priority,
+             .size     = size,
+             .left     = std::move(left),
+             .right    = std::move(right)});
+  }
+
+  pointer with_children(pointer l, pointer r) const {
+    return make(key, value, priority, std::move(l), std::move(r));
+  }
+
+  interval<K> key;
+  M value;
+  uint64_t priority;
+  size_t size;
+  pointer left;
+  pointer right;
+};
+
+// Returns the concatenation of `l` and `r`, every key of which must follow
+// every key of `l`.
+template <typename K, typename M>
+typename node<K, M>::pointer merge(typename node<K, M>::pointer const& l,
+                                   typename node<K, M>::pointer const& r) {
+  if (not l) { return r; }
+  if (not r) { return l; }
+  if (l->priority > r->priority) {
+    return l->with_children(l->left, merge<K, M>(l->right, r));
+  } else {
+    return r->with_children(merge<K, M>(l, r->left), r->right);
+  }
+}
+
+// Splits `t` into the entries whose lower bound precedes `k` and the rest.
+template <typename K, typename M>
+std::pair<typename node<K, M>::pointer, typename node<K, M>::pointer> split(
+    typename node<K, M>::pointer const& t, K const& k) {
+  if (not t) { return {}; }
+  if (t->key.lower_bound() < k) {
+    auto [l, r] = split<K, M>(t->right, k);
+    return {t->with_children(t->left, std::move(l)), std::move(r)};
+  } else {
+    auto [l, r] = split<K, M>(t->left, k);
+    return {std::move(l), t->with_children(std::move(r), t->right)};
+  }
+}
+
+// Removes the last entry of the non-empty tree `t`, returning the remaining
+// tree.
+template <typename K, typename M>
+typename node<K, M>::pointer pop_back(typename node<K, M>::pointer const& t) {
+  if (not t->right) { return t->left; }
+  return t->with_children(t->left, pop_back<K, M>(t->right));
+}
+
+// Removes the first entry of the non-empty tree `t`, returning the remaining
+// tree.
+template <typename K, typename M>
+typename node<K, M>::pointer pop_front(typename node<K, M>::pointer const& t) {
+  if (not t->left) { return t->right; }
+  return t->with_children(pop_front<K, M>(t->left), t->right);
+}
+
+template <typename K, typename M>
+node<K, M> const* back(node<K, M> const* t) {
+  if (t) {
+    while (t->right) { t = t->right.get(); }
+  }
+  return t;
+}
+
+template <typename K, typename M>
+node<K, M> const* front(node<K, M> const* t) {
+  if (t) {
+    while (t->left) { t = t->left.get(); }
+  }
+  return t;
+}
+
+}  // namespace internal_persistent_interval_map
+
+// A `persistent_interval_map<K, M>` associates keys of type `K` with mapped
+// values of type `M` with the same semantics as `interval_map<K, M>`, but is
+// designed to be read concurrently with writes.
+//
+// Every write produces a new immutable version of the map, sharing all but
+// O(log n) of its nodes with the previous version, and publishes it
+// atomically. Readers obtain a `snapshot` of the current version with `load`,
+// which is unaffected by subsequent writes and may be queried without any
+// synchronization for as long as it is held. `load` is not lock-free: it takes
+// a short spin lock, shared with the publication of new versions, for just
+// long enough to copy the pointer to the current version. Writers are
+// serialized with one another, but never block queries of existing snapshots.
+template <std::totally_ordered K, std::equality_comparable M>
+struct persistent_interval_map {
+  using key_type      = K;
+  using interval_type = ::nth::interval<key_type>;
+  using mapped_type   = M;
+
+  struct snapshot;
+
+  persistent_interval_map() = default;
+  persistent_interval_map(persistent_interval_map const&)            = delete;
+  persistent_interval_map& operator=(persistent_interval_map const&) = delete;
+
+  // Returns the most recently published version of the map. Takes a short spin
+  // lock, and so may briefly wait on a concurrent `load` or publication.
+  snapshot load() const { return snapshot(get_root()); }
+
+  // Publishes a new version of the map in which the keys are the union of
+  // those that were in the map previously or the elements contained in `i`.
+  // Their associated values will be `v` if the key is contained in `i` and the
+  // value it was previously otherwise.
+  template <std::totally_ordered_with<key_type> T,
+            std::convertible_to<mapped_type> V>
+  void insert_or_assign(::nth::interval<T> const& i, V&& v);
+
+ private:
+  using node    = internal_persistent_interval_map::node<K, M>;
+  using pointer = typename node::pointer;
+
+  // The published root is copied and replaced under a spin lock held only for
+  // the duration of the reference count update. All other work, for readers
+  // and writers alike, happens outside the lock.
+  void acquire_spin_lock() const {
+    bool locked = false;
+    while (not lock_.compare_exchange_weak(
+        locked, true, std::memory_order::acquire, std::memory_order::relaxed)) {
+      locked = false;
+    }
+  }
+
+  void release_spin_lock() const {
+    lock_.store(false, std::memory_order::release);
+  }
+
+  pointer get_root() const {
+    acquire_spin_lock();
+    pointer root = root_;
+    release_spin_lock();
+    return root;
+  }
+
+  void set_root(pointer root) {
+    acquire_spin_lock();
+    root_.swap(root);
+    release_spin_lock();
+    // The previous root, now held by `root`, is released outside of the lock.
+  }
+
+  // Returns a priority for a new node, distributed uniformly so that the treap
+  // is balanced in expectation. Must only be called by the active writer.
+  uint64_t next_priority() {
+    uint64_t z = (seed_ += 0x9e3779b97f4a7c15);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  pointer single(interval_type key, mapped_type value) {
+    return node::make(std::move(key), std::move(value), next_priority(),
+                      nullptr, nullptr);
+  }
+
+  absl::Mutex writer_mutex_;
+  uint64_t seed_ = 0;
+  pointer root_;
+  mutable std::atomic<bool> lock_ = false;
+};
+
+// An immutable version of a `persistent_interval_map`. Snapshots are cheap to
+// copy and may be shared freely between threads.
+template <std::totally_ordered K, std::equality_comparable M>
+struct persistent_interval_map<K, M>::snapshot {
+  snapshot() = default;
+
+  // Returns the number of disjoint intervals in the map.
+  size_t size() const { return root_ ? root_->size : 0; }
+
+  // Returns `true` if the map is empty and `false` otherwise.
+  bool empty() const { return root_ == nullptr; }
+
+  // Returns `true` if and only if the key `k` is contained in one of the
+  // intervals in the map.
+  bool contains(key_type const& k) const { return find(k) != nullptr; }
+
+  // If `k` is contained in the map, returns a pointer to the corresponding
+  // mapped value. Returns `nullptr` otherwise. The pointer remains valid for as
+  // long as any copy of this snapshot exists.
+  mapped_type const* find(key_type const& k) const {
+    node const* n = entry(k);
+    return n ? &n->value : nullptr;
+  }
+
+  // If `k` is contained in the map, returns a pointer to the interval
+  // containing `k`. Returns `nullptr` otherwise. The pointer remains valid for
+  // as long as any copy of this snapshot exists.
+  interval_type const* key_range(key_type const& k) const {
+    node const* n = entry(k);
+    return n ? &n->key : nullptr;
+  }
+
+  // If `k` is contained in the map, returns the corresponding mapped value.
+  // Behavior is undefined otherwise.
+  mapped_type const& at(key_type const& k) const {
+    mapped_type const* m = find(k);
+    NTH_REQUIRE((harden), m != nullptr);
+    return *m;
+  }
+
+  // Invokes `f` with each interval in the map and its mapped value, in
+  // increasing order.
+  template <std::invocable<interval_type const&, mapped_type const&> F>
+  void for_each(F&& f) const {
+    for_each(root_.get(), f);
+  }
+
+ private:
+  friend persistent_interval_map;
+
+  explicit snapshot(pointer root) : root_(std::move(root)) {}
+
+  node const* entry(key_type const& k) const {
+    node const* candidate = nullptr;
+    for (node const* n = root_.get(); n;) {
+      if (k < n->key.lower_bound()) {
+        n = n->left.get();
+      } else {
+        candidate = n;
+        n         = n->right.get();
+      }
+    }
+    return (candidate and k < candidate->key.upper_bound()) ? candidate
+                                                            : nullptr;
+  }
+
+  template <typename F>
+  static void for_each(node const* n, F& f) {
+    if (not n) { return; }
+    for_each(n->left.get(), f);
+    f(n->key, n->value);
+    for_each(n->right.get(), f);
+  }
+
+  pointer root_;
+};
+
+template <std::totally_ordered K, std::equality_comparable M>
+template <std::totally_ordered_with<K> T, std::convertible_to<M> V>
+void persistent_interval_map<K, M>::insert_or_assign(
+    ::nth::interval<T> const& i, V&& v) {
+  namespace internal = internal_persistent_interval_map;
+  if (i.empty()) { return; }
+
+  absl::MutexLock lock(&writer_mutex_);
+  key_type lower    = i.lower_bound();
+  key_type upper    = i.upper_bound();
+  mapped_type value = std::forward<V>(v);
+
+  // Entries in `middle` start within `i` and are replaced. The last entry of
+  // `before` and the last entry of `middle` may extend beyond `i`; whatever
+  // lies outside of `i` is kept as `left` and `right`.
+  auto [before, rest]  = internal::split<K, M>(root_, lower);
+  auto [middle, after] = internal::split<K, M>(rest, upper);
+  pointer left, right;
+  if (node const* last = internal::back(before.get());
+      last and lower < last->key.upper_bound()) {
+    if (upper < last->key.upper_bound()) {
+      right = single(interval_type(upper, last->key.upper_bound()),
+                     last->value);
+    }
+    left   = single(interval_type(last->key.lower_bound(), lower), last->value);
+    before = internal::pop_back<K, M>(before);
+  }
+  if (node const* last = internal::back(middle.get());
+      last and upper < last->key.upper_bound()) {
+    right = single(interval_type(upper, last->key.upper_bound()), last->value);
+  }
+
+  // Coalesce with remnants or abutting neighbors mapped to the same value.
+  if (left and left->value == value) {
+    lower = left->key.lower_bound();
+    left  = nullptr;
+  } else if (node const* prev = internal::back(before.get());
+             not left and prev and prev->key.upper_bound() == lower and
+             prev->value == value) {
+    lower  = prev->key.lower_bound();
+    before = internal::pop_back<K, M>(before);
+  }
+  if (right and right->value == value) {
+    upper = right->key.upper_bound();
+    right = nullptr;
+  } else if (node const* next = internal::front(after.get());
+             not right and next and next->key.lower_bound() == upper and
+             next->value == value) {
+    upper = next->key.upper_bound();
+    after = internal::pop_front<K, M>(after);
+  }
+
+  pointer root = internal::merge<K, M>(before, left);
+  root         = internal::merge<K, M>(
+      root, single(interval_type(std::move(lower), std::move(upper)),
+                   std::move(value)));
+  root = internal::merge<K, M>(root, right);
+  root = internal::merge<K, M>(root, after);
+  set_root(std::move(root));
+}
+
+}  // namespace nth
+
+#endif  // NTH_CONTAINER_PERSISTENT_INTERVAL_MAP_H
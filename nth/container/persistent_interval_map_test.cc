@@ -0,0 +1,235 @@
+#include "nth/container/persistent_interval_map.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nth/container/interval_map.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/test.h"
+
+namespace nth {
+namespace {
+
+using ::nth::debug::ElementsAreSequentially;
+
+template <typename K, typename M>
+std::vector<std::pair<interval<K>, M>> entries(
+    typename persistent_interval_map<K, M>::snapshot const& s) {
+  std::vector<std::pair<interval<K>, M>> result;
+  s.for_each(
+      [&](interval<K> const& i, M const& m) { result.emplace_back(i, m); });
+  return result;
+}
+
+NTH_TEST("persistent_interval_map/default") {
+  persistent_interval_map<int, std::string> map;
+  auto s = map.load();
+  NTH_EXPECT(s.empty());
+  NTH_EXPECT(s.size() == 0);
+  NTH_EXPECT(not s.contains(0));
+  NTH_EXPECT(s.find(0) == nullptr);
+}
+
+NTH_TEST("persistent_interval_map/insert_or_assign") {
+  using entry = std::pair<interval<int>, std::string>;
+  persistent_interval_map<int, std::string> map;
+  map.insert_or_assign(interval(3, 5), "hello");
+  NTH_EXPECT(entries<int, std::string>(map.load()) >>=
+             ElementsAreSequentially(entry(interval(3, 5), "hello")));
+
+  map.insert_or_assign(interval(5, 7), "hello");
+  NTH_EXPECT(entries<int, std::string>(map.load()) >>=
+             ElementsAreSequentially(entry(interval(3, 7), "hello")));
+
+  map.insert_or_assign(interval(4, 6), "world");
+  NTH_EXPECT(entries<int, std::string>(map.load()) >>=
+             ElementsAreSequentially(entry(interval(3, 4), "hello"),
+                                     entry(interval(4, 6), "world"),
+                                     entry(interval(6, 7), "hello")));
+
+  map.insert_or_assign(interval(0, 10), "x");
+  NTH_EXPECT(entries<int, std::string>(map.load()) >>=
+             ElementsAreSequentially(entry(interval(0, 10), "x")));
+
+  map.insert_or_assign(interval(5, 5), "y");
+  NTH_EXPECT(entries<int, std::string>(map.load()) >>=
+             ElementsAreSequentially(entry(interval(0, 10), "x")));
+}
+
+NTH_TEST("persistent_interval_map/lookup") {
+  persistent_interval_map<int, std::string> map;
+  map.insert_or_assign(interval(3, 5), "a");
+  map.insert_or_assign(interval(7, 9), "b");
+  auto s = map.load();
+  NTH_EXPECT(s.size() == 2);
+  NTH_EXPECT(not s.contains(2));
+  NTH_EXPECT(s.contains(3));
+  NTH_EXPECT(not s.contains(5));
+  NTH_EXPECT(s.at(4) == "a");
+  NTH_EXPECT(s.at(8) == "b");
+  NTH_EXPECT(s.find(6) == nullptr);
+  NTH_ASSERT(s.key_range(7) != nullptr);
+  NTH_EXPECT(*s.key_range(7) == interval(7, 9));
+}
+
+NTH_TEST("persistent_interval_map/snapshot-isolation") {
+  using entry = std::pair<interval<int>, std::string>;
+  persistent_interval_map<int, std::string> map;
+  map.insert_or_assign(interval(0, 10), "a");
+  auto before              = map.load();
+  std::string const* value = before.find(5);
+
+  map.insert_or_assign(interval(4, 6), "b");
+  auto after = map.load();
+
+  NTH_EXPECT(entries<int, std::string>(before) >>=
+             ElementsAreSequentially(entry(interval(0, 10), "a")));
+  NTH_EXPECT(entries<int, std::string>(after) >>=
+             ElementsAreSequentially(entry(interval(0, 4), "a"),
+                                     entry(interval(4, 6), "b"),
+                                     entry(interval(6, 10), "a")));
+  NTH_EXPECT(before.find(5) == value);
+  NTH_EXPECT(*value == "a");
+}
+
+NTH_TEST("persistent_interval_map/matches-interval_map") {
+  persistent_interval_map<int, int> persistent;
+  interval_map<int, int> map;
+  uint64_t state = 1;
+  auto next      = [&] {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    return static_cast<int>(state >> 58);
+  };
+  for (int n = 0; n < 1000; ++n) {
+    int lower = next();
+    int upper = lower + next() % 8;
+    int value = next() % 3;
+    persistent.insert_or_assign(interval(lower, upper), value);
+    map.insert_or_assign(interval(lower, upper), value);
+
+    auto s = persistent.load();
+    NTH_ASSERT(s.size() == static_cast<size_t>(
+                               std::ranges::distance(map.mapped_intervals())));
+    for (int k = -1; k < 72; ++k) {
+      int const* expected = map.contains(k) ? &map.at(k) : nullptr;
+      int const* actual   = s.find(k);
+      NTH_ASSERT((expected == nullptr) == (actual == nullptr));
+      if (expected) { NTH_ASSERT(*expected == *actual); }
+    }
+  }
+}
+
+NTH_TEST("persistent_interval_map/concurrent-readers") {
+  // The writer only ever assigns a single, increasing value to the whole of
+  // [0, 64), so every key in a snapshot is mapped to the same value, and
+  // successive snapshots never go backwards.
+  persistent_interval_map<int, int> map;
+  map.insert_or_assign(interval(0, 64), 0);
+  std::atomic<bool> done       = false;
+  std::atomic<bool> consistent = true;
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      int last = 0;
+      while (not done.load(std::memory_order_relaxed)) {
+        auto s    = map.load();
+        int first = s.at(0);
+        if (first < last) { consistent = false; }
+        last = first;
+        for (int k = 0; k < 64; ++k) {
+          if (s.at(k) != first) { consistent = false; }
+        }
+      }
+    });
+  }
+  for (int n = 1; n <= 1000; ++n) { map.insert_or_assign(interval(0, 64), n); }
+  done = true;
+  for (auto& reader : readers) { reader.join(); }
+
+  NTH_EXPECT(consistent.load());
+  NTH_EXPECT(map.load().size() == 1);
+  NTH_EXPECT(map.load().at(10) == 1000);
+}
+
+// An `interval_map` guarded by a reader-writer lock, against which the
+// persistent map is compared.
+struct locked_interval_map {
+  void insert_or_assign(interval<uint64_t> i, uint64_t v) {
+    std::unique_lock lock(mutex);
+    map.insert_or_assign(i, v);
+  }
+
+  bool contains(uint64_t k) const {
+    std::shared_lock lock(mutex);
+    return map.contains(k);
+  }
+
+  mutable std::shared_mutex mutex;
+  interval_map<uint64_t, uint64_t> map;
+};
+
+// Runs `thread_count` readers, each looking up 4096 keys, while a single writer
+// continuously assigns intervals.
+template <typename Write, typename Read>
+void read_while_writing(size_t thread_count, Write write, Read read) {
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    for (uint64_t i = 0; not done.load(std::memory_order_relaxed); ++i) {
+      uint64_t lower = (i * 0x9e3779b97f4a7c15) >> 44;
+      write(interval(lower, lower + 64), i % 4);
+    }
+  });
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < thread_count; ++t) {
+    readers.emplace_back([&] {
+      for (uint64_t k = 0; k < 4096; ++k) { read(k * 977); }
+    });
+  }
+  for (auto& reader : readers) { reader.join(); }
+  done = true;
+  writer.join();
+}
+
+NTH_TEST("persistent_interval_map/benchmark/read-while-writing",
+         size_t thread_count) {
+  NTH_MEASURE() {
+    persistent_interval_map<uint64_t, uint64_t> persistent;
+    locked_interval_map locked;
+    NTH_TIME("persistent") {
+      read_while_writing(
+          thread_count,
+          [&](interval<uint64_t> i, uint64_t v) {
+            persistent.insert_or_assign(i, v);
+          },
+          [&](uint64_t k) {
+            bool result = persistent.load().contains(k);
+            nth::DoNotOptimize(result);
+          });
+    }
+    NTH_TIME("reader-writer-lock") {
+      read_while_writing(
+          thread_count,
+          [&](interval<uint64_t> i, uint64_t v) {
+            locked.insert_or_assign(i, v);
+          },
+          [&](uint64_t k) {
+            bool result = locked.contains(k);
+            nth::DoNotOptimize(result);
+          });
+    }
+  }
+}
+
+NTH_INVOKE_TEST("persistent_interval_map/benchmark/read-while-writing") {
+  for (size_t thread_count : {1, 2, 4, 8}) { co_yield thread_count; }
+}
+
+}  // namespace
+}  // namespace nth
@@ -1,8 +1,14 @@
 #ifndef NTH_CONTAINER_STABLE_CONTAINER_H
 #define NTH_CONTAINER_STABLE_CONTAINER_H
 
+#include <compare>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "nth/container/stack.h"
 
@@ -36,8 +42,12 @@ struct stable_container {
 
   struct entry_type;
   struct const_entry_type;
-  struct iterator;
-  struct const_iterator;
+  template <bool Const>
+  struct iterator_impl;
+
+  // Iterators are random-access and are invalidated by any insertion.
+  using iterator       = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
 
   [[nodiscard]] iterator begin();
   [[nodiscard]] iterator end();
@@ -49,6 +59,8 @@ struct stable_container {
   [[nodiscard]] size_t size() const;
   [[nodiscard]] bool empty() const;
 
+  // Indexed access takes constant time. Behavior is undefined unless
+  // `index < size()`.
   [[nodiscard]] entry_type entry(size_t index);
   [[nodiscard]] const_entry_type entry(size_t index) const;
   [[nodiscard]] const_entry_type centry(size_t index) const;
@@ -68,6 +80,15 @@ struct stable_container {
 
   value_type* insertion_location();
 
+  // Chunk `k` holds `1 << k` elements, so the element at `index` resides in
+  // chunk `Log2Floor(index + 1)`, at an offset of `index + 1` less the number
+  // of elements in all preceding chunks.
+  static std::pair<size_t, size_t> locate(size_t index) {
+    size_t n = index + 1;
+    size_t k = Log2Floor(n);
+    return {k, n - (size_t{1} << k)};
+  }
+
   struct chunk {
     value_type* start;
     value_type* end;
@@ -75,6 +96,11 @@ struct stable_container {
 
     size_t remaining() const { return cap - end; }
   };
+  chunk* chunk_data() { return chunks_.top_span(chunks_.size()).data(); }
+  chunk const* chunk_data() const {
+    return chunks_.top_span(chunks_.size()).data();
+  }
+
   stack<chunk> chunks_;
 };
 
@@ -185,28 +211,21 @@ struct stable_container<T>::const_entry_type {
 
 template <typename T>
 stable_container<T>::entry_type stable_container<T>::entry(size_t index) {
-  // TODO: This is a particularly slow implementation.
-  auto iter = begin();
-  for (size_t i = 0; i < index; ++i) { ++iter; }
-  return entry_type(std::addressof(*iter), index);
+  auto [k, offset] = locate(index);
+  return entry_type(chunk_data()[k].start + offset, index);
 }
 
 template <typename T>
 stable_container<T>::const_entry_type stable_container<T>::entry(
     size_t index) const {
-  // TODO: This is a particularly slow implementation.
-  auto iter = begin();
-  for (size_t i = 0; i < index; ++i) { ++iter; }
-  return const_entry_type(std::addressof(*iter), index);
+  auto [k, offset] = locate(index);
+  return const_entry_type(chunk_data()[k].start + offset, index);
 }
 
 template <typename T>
 stable_container<T>::const_entry_type stable_container<T>::centry(
     size_t index) const {
-  // TODO: This is a particularly slow implementation.
-  auto iter = begin();
-  for (size_t i = 0; i < index; ++i) { ++iter; }
-  return const_entry_type(std::addressof(*iter), index);
+  return entry(index);
 }
 
 template <typename T>
@@ -220,121 +239,126 @@ stable_container<T>::value_type const& stable_container<T>::operator[](
 }
 
 template <typename T>
-struct stable_container<T>::iterator {
-  iterator& operator++() {
-    if (++ptr_ == stack_iter_->end and ++stack_iter_ != end_) {
-      ptr_ = stack_iter_->start;
-    }
-    return *this;
+template <bool Const>
+struct stable_container<T>::iterator_impl {
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type        = T;
+  using difference_type   = ptrdiff_t;
+  using reference         = std::conditional_t<Const, T const&, T&>;
+  using pointer           = std::conditional_t<Const, T const*, T*>;
+
+  iterator_impl() = default;
+
+  // Mutable iterators are implicitly convertible to const iterators.
+  operator iterator_impl<true>() const
+    requires(not Const)
+  {
+    return iterator_impl<true>(chunks_, index_);
+  }
+
+  [[nodiscard]] reference operator*() const {
+    auto [k, offset] = locate(index_);
+    return chunks_[k].start[offset];
+  }
+  [[nodiscard]] pointer operator->() const { return std::addressof(**this); }
+  [[nodiscard]] reference operator[](difference_type n) const {
+    return *(*this + n);
   }
 
-  iterator operator++(int) {
+  iterator_impl& operator++() {
+    ++index_;
+    return *this;
+  }
+  iterator_impl operator++(int) {
     auto copy = *this;
-    ++*this;
+    ++index_;
     return copy;
   }
-
-  [[nodiscard]] friend bool operator==(iterator const& lhs,
-                                       iterator const& rhs) {
-    return lhs.ptr_ == rhs.ptr_ and lhs.stack_iter_ == rhs.stack_iter_;
+  iterator_impl& operator--() {
+    --index_;
+    return *this;
   }
-  [[nodiscard]] friend bool operator!=(iterator const& lhs,
-                                       iterator const& rhs) {
-    return not(lhs == rhs);
+  iterator_impl operator--(int) {
+    auto copy = *this;
+    --index_;
+    return copy;
   }
-  [[nodiscard]] value_type& operator*() const { return *ptr_; }
-  [[nodiscard]] value_type* operator->() const { return ptr_; }
 
-  [[nodiscard]] operator const_iterator() const {
-    return const_iterator(ptr_, stack_iter_, end_);
+  iterator_impl& operator+=(difference_type n) {
+    index_ += n;
+    return *this;
   }
-
- private:
-  friend stable_container;
-
-  explicit iterator(value_type* ptr, chunk* stack_iter, chunk* end)
-      : ptr_(ptr), stack_iter_(stack_iter), end_(end) {}
-
-  value_type* ptr_;
-  chunk* stack_iter_;
-  chunk* end_;
-};
-
-template <typename T>
-struct stable_container<T>::const_iterator {
-  const_iterator& operator++() {
-    if (++ptr_ == stack_iter_->end and ++stack_iter_ != end_) {
-      ptr_ = stack_iter_->start;
-    }
+  iterator_impl& operator-=(difference_type n) {
+    index_ -= n;
     return *this;
   }
 
-  const_iterator operator++(int) {
-    auto copy = *this;
-    ++*this;
-    return copy;
+  [[nodiscard]] friend iterator_impl operator+(iterator_impl i,
+                                               difference_type n) {
+    return i += n;
+  }
+  [[nodiscard]] friend iterator_impl operator+(difference_type n,
+                                               iterator_impl i) {
+    return i += n;
+  }
+  [[nodiscard]] friend iterator_impl operator-(iterator_impl i,
+                                               difference_type n) {
+    return i -= n;
+  }
+  [[nodiscard]] friend difference_type operator-(iterator_impl const& lhs,
+                                                 iterator_impl const& rhs) {
+    return static_cast<difference_type>(lhs.index_) -
+           static_cast<difference_type>(rhs.index_);
   }
 
-  [[nodiscard]] friend bool operator==(const_iterator const& lhs,
-                                       const_iterator const& rhs) {
-    return lhs.ptr_ == rhs.ptr_ and lhs.stack_iter_ == rhs.stack_iter_;
+  [[nodiscard]] friend bool operator==(iterator_impl const& lhs,
+                                       iterator_impl const& rhs) {
+    return lhs.index_ == rhs.index_;
   }
-  [[nodiscard]] friend bool operator!=(const_iterator const& lhs,
-                                       const_iterator const& rhs) {
-    return not(lhs == rhs);
+  [[nodiscard]] friend std::strong_ordering operator<=>(
+      iterator_impl const& lhs, iterator_impl const& rhs) {
+    return lhs.index_ <=> rhs.index_;
   }
-  [[nodiscard]] value_type const& operator*() const { return *ptr_; }
-  [[nodiscard]] value_type const* operator->() const { return ptr_; }
 
  private:
   friend stable_container;
-  friend iterator;
+  friend iterator_impl<not Const>;
 
-  explicit const_iterator(value_type const* ptr, chunk const* stack_iter,
-                          chunk const* end)
-      : ptr_(ptr), stack_iter_(stack_iter), end_(end) {}
+  explicit iterator_impl(chunk const* chunks, size_t index)
+      : chunks_(chunks), index_(index) {}
 
-  value_type const* ptr_;
-  chunk const* stack_iter_;
-  chunk const* end_;
+  chunk const* chunks_ = nullptr;
+  size_t index_        = 0;
 };
 
 template <typename T>
 stable_container<T>::iterator stable_container<T>::begin() {
-  if (empty()) { return end(); }
-  std::span span = chunks_.top_span(chunks_.size());
-  return iterator(span[0].start, span.data(), span.data() + span.size());
+  return iterator(chunk_data(), 0);
 }
 
 template <typename T>
 stable_container<T>::iterator stable_container<T>::end() {
-  return iterator(chunks_.top().end, &chunks_.top() + 1, &chunks_.top() + 1);
+  return iterator(chunk_data(), size());
 }
 
 template <typename T>
 stable_container<T>::const_iterator stable_container<T>::begin() const {
-  if (empty()) { return end(); }
-  std::span span = chunks_.top_span(chunks_.size());
-  return const_iterator(span[0].start, span.data(), span.data() + span.size());
+  return const_iterator(chunk_data(), 0);
 }
 
 template <typename T>
 stable_container<T>::const_iterator stable_container<T>::end() const {
-  return const_iterator(chunks_.top().end, &chunks_.top() + 1,
-                        &chunks_.top() + 1);
+  return const_iterator(chunk_data(), size());
 }
 
 template <typename T>
 stable_container<T>::const_iterator stable_container<T>::cbegin() const {
-  if (empty()) { return end(); }
-  std::span span = chunks_.top_span(chunks_.size());
-  return const_iterator(span[0].start, span.data(), span.data() + span.size());
+  return begin();
 }
 
 template <typename T>
 stable_container<T>::const_iterator stable_container<T>::cend() const {
-  return const_iterator(chunks_.top().end, &chunks_.top() + 1,
-                        &chunks_.top() + 1);
+  return end();
 }
 
 }  // namespace nth
@@ -1,6 +1,7 @@
 #include "nth/container/stable_container.h"
 
 #include <array>
+#include <iterator>
 #include <string>
 
 #include "nth/test/test.h"
@@ -106,5 +107,72 @@ NTH_TEST("stable_container/basic/entry") {
   }
 }
 
+NTH_TEST("stable_container/entry-across-chunks") {
+  stable_container<size_t> c;
+  for (size_t i = 0; i < 5000; ++i) {
+    c.insert(i);
+    NTH_ASSERT(c[i] == i);
+  }
+  for (size_t i = 0; i < 5000; ++i) {
+    NTH_EXPECT(c[i] == i);
+    NTH_EXPECT(&c[i] == &*c.entry(i));
+  }
+}
+
+NTH_TEST("stable_container/random-access-iterator") {
+  static_assert(std::random_access_iterator<stable_container<int>::iterator>);
+  static_assert(
+      std::random_access_iterator<stable_container<int>::const_iterator>);
+
+  stable_container<int> c;
+  for (int i = 0; i < 100; ++i) { c.insert(i); }
+  NTH_EXPECT(c.end() - c.begin() == 100);
+
+  auto iter = c.begin() + 37;
+  NTH_EXPECT(*iter == 37);
+  NTH_EXPECT(iter[10] == 47);
+  iter -= 30;
+  NTH_EXPECT(*iter == 7);
+  NTH_EXPECT(*--iter == 6);
+  NTH_EXPECT(iter < c.end());
+  NTH_EXPECT(c.end() - 1 > iter);
+  NTH_EXPECT(*(c.end() - 1) == 99);
+
+  stable_container<int>::const_iterator citer = iter;
+  NTH_EXPECT(*citer == 6);
+  NTH_EXPECT(citer == iter);
+
+  std::reverse_iterator<stable_container<int>::iterator> r(c.end());
+  NTH_EXPECT(*r == 99);
+}
+
+NTH_TEST("stable_container/benchmark/indexed-read", size_t size) {
+  stable_container<size_t> c;
+  for (size_t i = 0; i < size; ++i) { c.insert(i); }
+  NTH_MEASURE() {
+    NTH_TIME("operator[]") {
+      // Visit indices in a scattered order so that reads are not sequential.
+      size_t index = 0;
+      for (size_t i = 0; i < 1024; ++i) {
+        index = (index + 7919) & (size - 1);
+        size_t value = c[index];
+        nth::DoNotOptimize(value);
+      }
+    }
+    NTH_TIME("iterator") {
+      auto iter = c.begin();
+      for (size_t i = 0; i < 1024; ++i) {
+        size_t value = iter[(i * 7919) & (size - 1)];
+        nth::DoNotOptimize(value);
+      }
+    }
+  }
+}
+
+NTH_INVOKE_TEST("stable_container/benchmark/indexed-read") {
+  co_yield size_t{1} << 10;
+  co_yield size_t{1} << 20;
+}
+
 }  // namespace
 }  // namespace nth
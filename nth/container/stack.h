@@ -3,6 +3,8 @@
 
 #include <concepts>
 #include <cstddef>
+#include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <new>
@@ -12,22 +14,65 @@
 #include "nth/debug/debug.h"
 
 namespace nth {
+namespace internal_stack {
+
+// Storage for `N` objects of type `T` held directly in a `stack`.
+template <typename T, size_t N>
+struct inline_buffer {
+  T* data() { return reinterpret_cast<T*>(bytes_); }
+  T const* data() const { return reinterpret_cast<T const*>(bytes_); }
+
+ private:
+  alignas(T) std::byte bytes_[N * sizeof(T)];
+};
 
 template <typename T>
+struct inline_buffer<T, 0> {
+  T* data() { return nullptr; }
+  T const* data() const { return nullptr; }
+};
+
+// The unit in which heap buffers are requested from the allocator, so that
+// they are suitably aligned for both elements and the trailing allocation size.
+template <size_t Alignment>
+struct alignas(Alignment) allocation_unit {
+  std::byte bytes[Alignment];
+};
+
+}  // namespace internal_stack
+
+// `stack<T, N, Allocator>` is a last-in, first-out container of `T`. The first
+// `N` elements are stored within the `stack` object itself, and only once that
+// capacity is exceeded are elements moved to a buffer obtained from
+// `Allocator`. A default-constructed `stack` never allocates; with `N == 0`,
+// the first allocation happens upon the first push.
+//
+// The allocator is propagated on copy assignment, move assignment and swap
+// only as dictated by `std::allocator_traits<Allocator>`. When it is not
+// propagated and the two allocators compare unequal, elements are moved (or
+// copied) one at a time into a buffer obtained from the existing allocator.
+template <typename T, size_t N = 0, typename Allocator = std::allocator<T>>
 struct stack {
   using value_type      = T;
   using size_type       = size_t;
   using reference       = T&;
   using const_reference = T const&;
+  using allocator_type  = Allocator;
 
-  stack();
+  // The number of elements which can be held without allocating.
+  static constexpr size_type inline_capacity = N;
+
+  stack() : stack(Allocator()) {}
+  explicit stack(Allocator const& a);
   stack(stack const& s);
+  stack(stack const& s, Allocator const& a);
   stack(stack&& s);
-  stack(std::initializer_list<value_type> vs);
+  stack(std::initializer_list<value_type> vs, Allocator const& a = Allocator());
   stack& operator=(stack&& s);
   stack& operator=(stack const& s);
-  ~stack() requires(not std::is_trivially_destructible_v<value_type>);
-  ~stack() requires(std::is_trivially_destructible_v<value_type>);
+  ~stack();
+
+  allocator_type get_allocator() const { return allocator_; }
 
   // Pushes `value` onto the top of the stack.
   void push(value_type const& value);
@@ -60,22 +105,27 @@ struct stack {
     NTH_REQUIRE((debug), size() >= n);
     return std::span(next_ - n, n);
   }
-  template <size_type N>
-  [[nodiscard]] std::span<value_type, N> top_span() {
-    NTH_REQUIRE((debug), size() >= N);
-    return std::span<value_type, N>(next_ - N, N);
+  template <size_type M>
+  [[nodiscard]] std::span<value_type, M> top_span() {
+    NTH_REQUIRE((debug), size() >= M);
+    return std::span<value_type, M>(next_ - M, M);
   }
-  template <size_type N>
-  [[nodiscard]] std::span<value_type const, N> top_span() const {
-    NTH_REQUIRE((debug), size() >= N);
-    return std::span<value_type const, N>(next_ - N, N);
+  template <size_type M>
+  [[nodiscard]] std::span<value_type const, M> top_span() const {
+    NTH_REQUIRE((debug), size() >= M);
+    return std::span<value_type const, M>(next_ - M, M);
   }
 
-  [[nodiscard]] std::pair<value_type*, size_type> release() && {
-    return std::pair(std::exchange(next_, nullptr), left_);
+  // Relinquishes ownership of the stack's buffer, which may later be handed
+  // back to `reconstitute_from`. Only available for stacks without inline
+  // capacity, as an inline buffer cannot outlive the stack holding it.
+  [[nodiscard]] std::pair<value_type*, size_type> release() &&
+      requires(N == 0) {
+    return std::pair(std::exchange(next_, nullptr), std::exchange(left_, 0));
   }
 
-  static stack reconstitute_from(value_type* next, size_type left) {
+  static stack reconstitute_from(value_type* next, size_type left)
+      requires(N == 0) {
     return stack(next, left);
   }
 
@@ -91,7 +141,11 @@ struct stack {
   // Returns the amount of space left before a reallocation is required.
   [[nodiscard]] constexpr size_type remaining_capacity() const { return left_; }
 
-  [[nodiscard]] size_type capacity() const { return *capacity_address(); }
+  [[nodiscard]] size_type capacity() const {
+    if (is_inline()) { return N; }
+    if (next_ == nullptr) { return 0; }
+    return capacity_offset(*allocation_size_address()) / sizeof(value_type);
+  }
 
   // Reserves enough capacity to store at least `n` elements in total.
   void reserve(size_type n);
@@ -99,23 +153,63 @@ struct stack {
  private:
   explicit stack(value_type* next, size_type left) : next_(next), left_(left) {}
 
-  void reallocate();
+  // Heap buffers hold the elements followed by the size in bytes of the buffer,
+  // so that the capacity (and the size to return to the allocator) can be
+  // recovered from `next_` and `left_` alone.
+  static constexpr size_type Alignment =
+      alignof(value_type) > alignof(size_type) ? alignof(value_type)
+                                               : alignof(size_type);
+  using allocation_unit = internal_stack::allocation_unit<Alignment>;
+  using unit_allocator  = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<allocation_unit>;
+
+  // Returns whether the elements are held in the inline buffer.
+  bool is_inline() const {
+    if constexpr (N == 0) {
+      return false;
+    } else {
+      value_type const* data = inline_.data();
+      return std::less_equal<>{}(data, next_) and
+             std::less_equal<>{}(next_, data + N);
+    }
+  }
 
-  static size_type* round_up_for_capacity(void* ptr);
+  value_type* data() { return next_ - size(); }
 
-  size_type* capacity_address() { return round_up_for_capacity(next_ + left_); }
-  size_type const* capacity_address() const {
-    return const_cast<stack*>(this)->capacity_address();
+  // Resets the stack to hold no elements and own no heap buffer.
+  void reset() {
+    next_ = inline_.data();
+    left_ = N;
   }
 
-  static consteval std::align_val_t alignment() {
-    return alignof(value_type) > alignof(size_type)
-               ? std::align_val_t{alignof(value_type)}
-               : std::align_val_t{alignof(size_type)};
+  // Destroys all elements and returns any heap buffer to the allocator.
+  void destroy();
+
+  // Takes the contents of `s`, leaving `s` empty. Any heap buffer owned by `s`
+  // is adopted, so the allocators of `*this` and `s` must compare equal.
+  void take(stack& s);
+
+  // Moves each element of `s` into this stack's own storage, leaving `s`
+  // empty.
+  void move_elements_from(stack& s);
+
+  bool has_equal_allocator(stack const& s) const {
+    if constexpr (std::allocator_traits<Allocator>::is_always_equal::value) {
+      return true;
+    } else {
+      return allocator_ == s.allocator_;
+    }
   }
 
-  static consteval size_type min_alloc_size() {
-    return buffer_size_from_capacity(1);
+  void reallocate();
+
+  static size_type* round_up_for_capacity(void* ptr);
+
+  size_type* allocation_size_address() {
+    return round_up_for_capacity(next_ + left_);
+  }
+  size_type const* allocation_size_address() const {
+    return const_cast<stack*>(this)->allocation_size_address();
   }
 
   static constexpr size_type capacity_offset(size_type buffer_size) {
@@ -132,96 +226,145 @@ struct stack {
 
   value_type* next_;
   size_type left_;
+  [[no_unique_address]] internal_stack::inline_buffer<value_type, N> inline_;
+  [[no_unique_address]] Allocator allocator_;
 };
 
-template <typename T>
-stack<T>::stack()
-    : stack(static_cast<value_type*>(
-                ::operator new(min_alloc_size(), alignment())),
-            capacity_offset(min_alloc_size()) / sizeof(value_type)) {
-  *capacity_address() = left_;
+template <typename T, size_t N, typename A>
+stack<T, N, A>::stack(A const& a) : allocator_(a) {
+  reset();
 }
 
-template <typename T>
-stack<T>::stack(stack const& s)
-    : stack(static_cast<value_type*>(::operator new(
-                buffer_size_from_capacity(s.capacity()), alignment())),
-            s.left_) {
+template <typename T, size_t N, typename A>
+stack<T, N, A>::stack(stack const& s)
+    : stack(s, std::allocator_traits<A>::select_on_container_copy_construction(
+                   s.allocator_)) {}
+
+template <typename T, size_t N, typename A>
+stack<T, N, A>::stack(stack const& s, A const& a) : allocator_(a) {
+  reset();
+  reserve(s.size());
   value_type const* e = s.next_;
   for (value_type const* b = s.next_ - s.size(); b != e; ++b) {
     next_ = 1 + new (next_) value_type(*b);
+    --left_;
   }
-  *capacity_address() = s.capacity();
 }
 
-template <typename T>
-stack<T>::stack(stack&& s)
-    : stack(std::exchange(s.next_, nullptr), std::exchange(s.left_, 0)) {}
+template <typename T, size_t N, typename A>
+stack<T, N, A>::stack(stack&& s) : allocator_(std::move(s.allocator_)) {
+  reset();
+  take(s);
+}
 
-template <typename T>
-stack<T>& stack<T>::operator=(stack&& s) {
-  next_ = std::exchange(s.next_, nullptr);
-  left_ = std::exchange(s.left_, 0);
+template <typename T, size_t N, typename A>
+stack<T, N, A>& stack<T, N, A>::operator=(stack&& s) {
+  if (this == &s) { return *this; }
+  if constexpr (std::allocator_traits<
+                    A>::propagate_on_container_move_assignment::value) {
+    destroy();
+    reset();
+    allocator_ = std::move(s.allocator_);
+    take(s);
+  } else if (has_equal_allocator(s)) {
+    destroy();
+    reset();
+    take(s);
+  } else {
+    move_elements_from(s);
+  }
   return *this;
 }
 
-template <typename T>
-stack<T>& stack<T>::operator=(stack const& s) {
-  next_ = static_cast<value_type*>(
-      ::operator new(buffer_size_from_capacity(s.capacity()), alignment()));
-  left_ = s.left_;
+template <typename T, size_t N, typename A>
+stack<T, N, A>& stack<T, N, A>::operator=(stack const& s) {
+  if (this == &s) { return *this; }
+  constexpr bool Propagate =
+      std::allocator_traits<A>::propagate_on_container_copy_assignment::value;
+  // Copying into a separate stack first leaves `*this` unchanged should an
+  // element's copy constructor throw. The copy uses the allocator that `*this`
+  // is to end up with, so its buffer may always be adopted.
+  stack copy(s, Propagate ? s.allocator_ : allocator_);
+  destroy();
+  reset();
+  if constexpr (Propagate) { allocator_ = std::move(copy.allocator_); }
+  take(copy);
+  return *this;
+}
 
-  value_type const* e = s.next_;
-  for (value_type const* b = s.next_ - s.size(); b != e; ++b) {
-    next_ = 1 + new (next_) value_type(*b);
+template <typename T, size_t N, typename A>
+stack<T, N, A>::~stack() {
+  destroy();
+}
+
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::destroy() {
+  if (next_ == nullptr) { return; }
+  value_type* b = data();
+  if constexpr (not std::is_trivially_destructible_v<value_type>) {
+    for (value_type* e = next_; b != e;) { (--e)->~value_type(); }
+  }
+  if (not is_inline()) {
+    size_type bytes = *allocation_size_address();
+    unit_allocator units(allocator_);
+    std::allocator_traits<unit_allocator>::deallocate(
+        units, reinterpret_cast<allocation_unit*>(b),
+        bytes / sizeof(allocation_unit));
   }
-  *capacity_address() = s.capacity();
-  return *this;
 }
 
-template <typename T>
-stack<T>::~stack() requires(not std::is_trivially_destructible_v<value_type>) {
-  if (next_) {
-    value_type* e = next_;
-    value_type* b = e - size();
-    while (b != e) { (--e)->~value_type(); }
-    ::operator delete(static_cast<void*>(b), alignment());
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::take(stack& s) {
+  if (not s.is_inline()) {
+    next_ = std::exchange(s.next_, nullptr);
+    left_ = std::exchange(s.left_, 0);
+  } else {
+    for (value_type* p = s.data(); p != s.next_; ++p) {
+      next_ = 1 + new (next_) value_type(static_cast<value_type&&>(*p));
+      --left_;
+      p->~value_type();
+    }
   }
+  s.reset();
 }
 
-template <typename T>
-stack<T>::~stack() requires(std::is_trivially_destructible_v<value_type>) {
-  if (next_) {
-    ::operator delete(static_cast<void*>(next_ - size()), alignment());
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::move_elements_from(stack& s) {
+  pop(size());
+  reserve(s.size());
+  for (value_type* p = s.data(); p != s.next_; ++p) {
+    next_ = 1 + new (next_) value_type(static_cast<value_type&&>(*p));
+    --left_;
   }
+  s.pop(s.size());
 }
 
-template <typename T>
-void stack<T>::push(value_type const& value) {
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::push(value_type const& value) {
   if (left_ == 0) { reallocate(); }
   next_ = 1 + new (next_) value_type(value);
   --left_;
 }
 
-template <typename T>
-void stack<T>::push(value_type&& value) {
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::push(value_type&& value) {
   if (left_ == 0) { reallocate(); }
   next_ = 1 + new (next_) value_type(static_cast<value_type&&>(value));
   --left_;
 }
 
-template <typename T>
+template <typename T, size_t N, typename A>
 template <typename... Args>
 requires std::constructible_from<T, Args...>
-decltype(auto) stack<T>::emplace(Args&&... args) {
+decltype(auto) stack<T, N, A>::emplace(Args&&... args) {
   if (left_ == 0) { reallocate(); }
   next_ = 1 + new (next_) value_type(std::forward<Args>(args)...);
   --left_;
-  return *next_;
+  return *(next_ - 1);
 }
 
-template <typename T>
-void stack<T>::pop() {
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::pop() {
   NTH_REQUIRE((debug), not empty());
   if constexpr (std::is_trivially_destructible_v<value_type>) {
     --next_;
@@ -231,8 +374,8 @@ void stack<T>::pop() {
   ++left_;
 }
 
-template <typename T>
-void stack<T>::pop(size_t n) {
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::pop(size_t n) {
   NTH_REQUIRE((debug), size() >= n);
   if constexpr (std::is_trivially_destructible_v<value_type>) {
     next_ -= n;
@@ -242,14 +385,30 @@ void stack<T>::pop(size_t n) {
   left_ += n;
 }
 
-template <typename T>
-void stack<T>::swap(stack& other) {
-  std::swap(next_, other.next_);
-  std::swap(left_, other.left_);
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::swap(stack& other) {
+  constexpr bool Propagate =
+      std::allocator_traits<A>::propagate_on_container_swap::value;
+  // Heap buffers may only be exchanged if each will be returned to the
+  // allocator it came from.
+  if (not is_inline() and not other.is_inline() and
+      (Propagate or has_equal_allocator(other))) {
+    std::swap(next_, other.next_);
+    std::swap(left_, other.left_);
+    if constexpr (Propagate) {
+      using std::swap;
+      swap(allocator_, other.allocator_);
+    }
+  } else {
+    stack s(std::move(other));
+    other = std::move(*this);
+    *this = std::move(s);
+  }
 }
 
-template <typename T>
-typename stack<T>::size_type* stack<T>::round_up_for_capacity(void* ptr) {
+template <typename T, size_t N, typename A>
+typename stack<T, N, A>::size_type* stack<T, N, A>::round_up_for_capacity(
+    void* ptr) {
   // TODO: This can be technically undefined behavior because this isn't
   // actually the length of the buffer.
   size_t width = 2 * sizeof(size_type);
@@ -257,46 +416,48 @@ typename stack<T>::size_type* stack<T>::round_up_for_capacity(void* ptr) {
       std::align(alignof(size_type), sizeof(size_type), ptr, width));
 }
 
-template <typename T>
-stack<T>::stack(std::initializer_list<typename stack<T>::value_type> vs)
-    : stack() {
+template <typename T, size_t N, typename A>
+stack<T, N, A>::stack(std::initializer_list<value_type> vs, A const& a)
+    : stack(a) {
+  reserve(vs.size());
   for (value_type const& v : vs) { push(v); }
 }
 
-template <typename T>
-void stack<T>::reallocate() {
-  size_type cap         = capacity();
-  size_type buffer_size = buffer_size_from_capacity(cap);
-  reserve(buffer_size / sizeof(value_type) + cap);
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::reallocate() {
+  reserve(capacity() + 1);
 }
 
-template <typename T>
-void stack<T>::reserve(size_type n) {
+template <typename T, size_t N, typename A>
+void stack<T, N, A>::reserve(size_type n) {
   size_type cap = capacity();
-  if (n < cap) [[unlikely]] { return; }
-  size_type buffer_size  = buffer_size_from_capacity(cap);
+  if (n <= cap) { return; }
   size_type new_capacity = (n > 2 * cap) ? n : 2 * cap;
-  size_type alloc_size   = new_capacity * sizeof(value_type) +
-                         (buffer_size - cap * sizeof(value_type));
-  void* new_alloc     = ::operator new(alloc_size, alignment());
-  value_type* new_ptr = static_cast<value_type*>(new_alloc);
-  ptrdiff_t size = static_cast<ptrdiff_t>(cap) - static_cast<ptrdiff_t>(left_);
-  value_type* old_start = next_ - size;
-  if constexpr (std::is_trivially_copyable_v<value_type> and
-                std::is_trivially_destructible_v<value_type>) {
-    std::memcpy(new_ptr, old_start, size * sizeof(value_type));
-    new_ptr += size;
-  } else {
-    for (value_type* p = old_start; p != next_; ++p) {
-      new_ptr = 1 + new (new_ptr) value_type(static_cast<value_type&&>(*p));
-      p->~value_type();
+  size_type alloc_size   = buffer_size_from_capacity(new_capacity);
+  unit_allocator units(allocator_);
+  value_type* new_ptr = reinterpret_cast<value_type*>(
+      std::allocator_traits<unit_allocator>::allocate(
+          units, alloc_size / sizeof(allocation_unit)));
+
+  size_type size = cap - left_;
+  if (next_ != nullptr) {
+    value_type* old_start = next_ - size;
+    if constexpr (std::is_trivially_copyable_v<value_type> and
+                  std::is_trivially_destructible_v<value_type>) {
+      std::memcpy(new_ptr, old_start, size * sizeof(value_type));
+    } else {
+      value_type* p = new_ptr;
+      for (value_type* q = old_start; q != next_; ++q) {
+        p = 1 + new (p) value_type(static_cast<value_type&&>(*q));
+      }
     }
+    // Destroys the moved-from elements and releases the old buffer, if any.
+    destroy();
   }
-  ::operator delete(old_start, alignment());
 
-  next_               = new_ptr;
-  left_               = capacity_offset(alloc_size) / sizeof(value_type) - size;
-  *capacity_address() = capacity_offset(alloc_size) / sizeof(value_type);
+  next_ = new_ptr + size;
+  left_ = capacity_offset(alloc_size) / sizeof(value_type) - size;
+  *allocation_size_address() = alloc_size;
 }
 
 }  // namespace nth
@@ -1,7 +1,13 @@
 #include "nth/container/stack.h"
 
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "nth/test/test.h"
 #include "nth/test/benchmark.h"
@@ -192,6 +198,179 @@ NTH_INVOKE_TEST("stack/size-unchanged-when/*") {
   co_yield stack<std::string>{"hello", "world"};
 }
 
+NTH_TEST("stack/inline/spill", auto type) {
+  using T = nth::type_t<type>;
+  stack<T, 4> s;
+  NTH_EXPECT(s.capacity() == size_t{4});
+  for (size_t i = 0; i < 4; ++i) { s.push(T{}); }
+  NTH_EXPECT(s.capacity() == size_t{4});
+  s.push(T{});
+  NTH_EXPECT(s.size() == size_t{5});
+  NTH_EXPECT(s.capacity() >= size_t{5});
+  for (size_t i = 0; i < 5; ++i) { s.pop(); }
+  NTH_EXPECT(s.empty());
+}
+
+NTH_TEST("stack/inline/copy-and-move", auto type) {
+  using T = nth::type_t<type>;
+  stack<T, 2> inline_stack, heap_stack;
+  inline_stack.push(T{});
+  for (size_t i = 0; i < 10; ++i) { heap_stack.push(T{}); }
+
+  stack<T, 2> copy = inline_stack;
+  NTH_EXPECT(copy.size() == size_t{1});
+  copy = heap_stack;
+  NTH_EXPECT(copy.size() == size_t{10});
+
+  stack<T, 2> moved = std::move(copy);
+  NTH_EXPECT(moved.size() == size_t{10});
+  moved = std::move(inline_stack);
+  NTH_EXPECT(moved.size() == size_t{1});
+
+  moved.swap(heap_stack);
+  NTH_EXPECT(moved.size() == size_t{10});
+  NTH_EXPECT(heap_stack.size() == size_t{1});
+}
+
+NTH_INVOKE_TEST("stack/inline/*") {
+  co_yield nth::type<std::string>;
+  co_yield nth::type<uint64_t>;
+  co_yield nth::type<uint8_t>;
+  co_yield nth::type<std::array<char, 11>>;
+}
+
+NTH_TEST("stack/inline-contents") {
+  stack<std::string, 2> s = {"a", "b", "c"};
+  NTH_EXPECT(s.top() == "c");
+  s.pop();
+  stack<std::string, 2> t = std::move(s);
+  NTH_EXPECT(t.top() == "b");
+  t.pop();
+  NTH_EXPECT(t.top() == "a");
+}
+
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+  using value_type = T;
+  template <typename U>
+  struct rebind {
+    using other = CountingAllocator<U>;
+  };
+
+  explicit CountingAllocator(int* count) : count(count) {}
+  template <typename U>
+  CountingAllocator(CountingAllocator<U> const& a) : count(a.count) {}
+
+  T* allocate(size_t n) {
+    ++*count;
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    --*count;
+    std::allocator<T>::deallocate(p, n);
+  }
+
+  int* count;
+};
+
+NTH_TEST("stack/allocator") {
+  int count = 0;
+  CountingAllocator<int> allocator(&count);
+  {
+    stack<int, 0, CountingAllocator<int>> s(allocator);
+    NTH_EXPECT(count == 0);
+    s.push(1);
+    NTH_EXPECT(count == 1);
+    for (int i = 0; i < 100; ++i) { s.push(i); }
+    NTH_EXPECT(count == 1);
+  }
+  NTH_EXPECT(count == 0);
+
+  {
+    stack<int, 4, CountingAllocator<int>> s(allocator);
+    for (int i = 0; i < 4; ++i) { s.push(i); }
+    NTH_EXPECT(count == 0);
+    s.push(4);
+    NTH_EXPECT(count == 1);
+  }
+  NTH_EXPECT(count == 0);
+}
+
+// A memory resource which counts the number of its outstanding allocations.
+struct CountingResource : std::pmr::memory_resource {
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++count;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    --count;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(memory_resource const& r) const noexcept override {
+    return this == &r;
+  }
+
+  int count = 0;
+};
+
+template <size_t N>
+using pmr_stack =
+    stack<std::string, N, std::pmr::polymorphic_allocator<std::string>>;
+
+template <size_t N>
+std::vector<std::string> Contents(pmr_stack<N> s) {
+  std::vector<std::string> v;
+  for (; not s.empty(); s.pop()) { v.push_back(s.top()); }
+  return v;
+}
+
+NTH_TEST("stack/pmr-allocator", auto n) {
+  constexpr size_t N = nth::type_t<n>::value;
+  std::vector<std::string> const b_a = {"b", "a"};
+  CountingResource r1, r2;
+  {
+    pmr_stack<N> s1(&r1);
+    pmr_stack<N> s2(&r2);
+    for (int i = 0; i < 8; ++i) { s1.push(std::to_string(i)); }
+    for (int i = 0; i < 4; ++i) { s2.push(std::to_string(10 + i)); }
+
+    // Allocators are not propagated, and as they compare unequal each stack
+    // keeps drawing from its own resource.
+    s1 = std::move(s2);
+    NTH_EXPECT(s1.get_allocator().resource() == &r1);
+    NTH_EXPECT(s2.get_allocator().resource() == &r2);
+    NTH_EXPECT(s1.size() == 4u);
+    NTH_EXPECT(s2.empty());
+    NTH_EXPECT(s1.top() == "13");
+
+    s2.push("a");
+    s2.push("b");
+    s1 = s2;
+    NTH_EXPECT(s1.get_allocator().resource() == &r1);
+    NTH_EXPECT(Contents<N>(s1) == b_a);
+
+    for (int i = 0; i < 8; ++i) { s2.push(std::to_string(i)); }
+    s1.swap(s2);
+    NTH_EXPECT(s1.get_allocator().resource() == &r1);
+    NTH_EXPECT(s2.get_allocator().resource() == &r2);
+    NTH_EXPECT(s1.size() == 10u);
+    NTH_EXPECT(Contents<N>(s2) == b_a);
+    NTH_EXPECT(s1.top() == "7");
+
+    // Moving between stacks sharing a resource adopts the buffer.
+    pmr_stack<N> s3(&r1);
+    s3 = std::move(s1);
+    NTH_EXPECT(s3.size() == 10u);
+    NTH_EXPECT(s1.empty());
+  }
+  NTH_EXPECT(r1.count == 0);
+  NTH_EXPECT(r2.count == 0);
+}
+
+NTH_INVOKE_TEST("stack/pmr-allocator") {
+  co_yield nth::type<std::integral_constant<size_t, 0>>;
+  co_yield nth::type<std::integral_constant<size_t, 2>>;
+}
 
 NTH_TEST("stack/benchmark/push", auto t) {
   NTH_MEASURE() {
@@ -204,6 +383,21 @@ NTH_TEST("stack/benchmark/push", auto t) {
   }
 }
 
+NTH_TEST("stack/benchmark/construct-and-push") {
+  NTH_MEASURE() {
+    NTH_TIME("heap") {
+      nth::stack<int> stack;
+      for (int i = 0; i < 4; ++i) { stack.push(i); }
+      nth::DoNotOptimize(stack);
+    }
+    NTH_TIME("inline") {
+      nth::stack<int, 8> stack;
+      for (int i = 0; i < 4; ++i) { stack.push(i); }
+      nth::DoNotOptimize(stack);
+    }
+  }
+}
+
 NTH_INVOKE_TEST("stack/benchmark/push") {
   co_yield nth::type<int>;
   co_yield nth::type<std::string>;
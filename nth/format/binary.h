@@ -0,0 +1,519 @@
+#ifndef NTH_FORMAT_BINARY_H
+#define NTH_FORMAT_BINARY_H
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "nth/container/stack.h"
+#include "nth/format/format.h"
+#include "nth/hash/fnv1a.h"
+#include "nth/io/reader/reader.h"
+#include "nth/io/writer/writer.h"
+#include "nth/meta/concepts/convertible.h"
+#include "nth/types/reflect.h"
+#include "nth/types/structure.h"
+
+// This header provides a compact binary serialization format along with a
+// matching decoder. The format is driven by the same structural categories as
+// `nth::json_formatter`, so any type which can be formatted as JSON can be
+// encoded, but the encoding is far denser:
+//
+//   * Booleans are a single byte.
+//   * Integers and floating-point values are written at their native width in
+//     little-endian byte order.
+//   * Strings are a varint-encoded length followed by their bytes.
+//   * `std::optional` is a single presence byte followed by the value, if any.
+//   * Sequences are a varint-encoded element count followed by each element.
+//   * Associative containers are a varint-encoded entry count followed by
+//     alternating keys and values.
+//   * Reflectable objects are their fields, in declaration order, with no
+//     field names or delimiters.
+//
+// Varints use the LEB128 encoding: seven bits per byte, least-significant
+// group first, with the high bit of each byte set if more bytes follow.
+//
+// Because objects carry no field names, the encoding is only meaningful to a
+// reader that agrees on the type being decoded. Writers may optionally prefix
+// the encoding with a hash of the type's shape (see `binary_schema_hash`) so
+// that readers can detect a mismatch rather than decoding garbage.
+
+namespace nth {
+namespace internal_binary {
+
+template <typename>
+struct binary_structure {
+  static constexpr structure value = structure::unknown;
+};
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+struct binary_structure<T> {
+  static constexpr structure value = structure::primitive;
+};
+
+template <nth::explicitly_convertible_to<std::string_view> T>
+struct binary_structure<T> {
+  static constexpr structure value = structure::primitive;
+};
+
+template <typename T>
+concept seq = requires(T t) {
+  std::begin(t);
+  std::end(t);
+} and not nth::explicitly_convertible_to<T, std::string_view>;
+template <seq T>
+struct binary_structure<T> {
+  static constexpr structure value = structure::sequence;
+};
+
+template <seq T>
+  requires(requires(T t) {
+    typename T::key_type;
+    typename T::mapped_type;
+  })
+struct binary_structure<T> {
+  static constexpr structure value = structure::associative;
+};
+
+template <typename T>
+  requires(nth::reflectable<T> and not seq<T> and
+           nth::reflect::field_count<T, nth::reflect::base_count<T>> >= 0)
+struct binary_structure<T> {
+  static constexpr structure value = structure::object;
+};
+
+template <typename T>
+concept optional_type = requires { typename T::value_type; } and
+                        std::same_as<T, std::optional<typename T::value_type>>;
+
+inline constexpr bool type_is_encodable = false;
+
+// The maximum number of bytes in the varint encoding of a `uint64_t`.
+inline constexpr int MaxVarintSize = 10;
+
+template <std::unsigned_integral U>
+void write_little_endian(io::writer auto& w, U n) {
+  std::byte bytes[sizeof(U)];
+  for (size_t i = 0; i < sizeof(U); ++i) {
+    bytes[i] = static_cast<std::byte>(n >> (8 * i));
+  }
+  w.write(std::span<std::byte const>(bytes));
+}
+
+inline void write_varint(io::writer auto& w, uint64_t n) {
+  std::byte bytes[MaxVarintSize];
+  size_t size = 0;
+  while (n >= 0x80) {
+    bytes[size++] = static_cast<std::byte>(n | 0x80);
+    n >>= 7;
+  }
+  bytes[size++] = static_cast<std::byte>(n);
+  w.write(std::span<std::byte const>(bytes, size));
+}
+
+// Appends a textual description of the shape of `T` to `s`. Two types have the
+// same description exactly when their encodings are interchangeable.
+// Recursive types are not supported.
+template <typename T>
+void append_schema(std::string& s) {
+  if constexpr (std::same_as<T, bool>) {
+    s += 'b';
+  } else if constexpr (std::integral<T>) {
+    s += std::is_signed_v<T> ? 'i' : 'u';
+    s += static_cast<char>('0' + sizeof(T));
+  } else if constexpr (std::floating_point<T>) {
+    s += 'f';
+    s += static_cast<char>('0' + sizeof(T));
+  } else if constexpr (nth::explicitly_convertible_to<T, std::string_view>) {
+    s += 's';
+  } else if constexpr (optional_type<T>) {
+    s += '?';
+    internal_binary::append_schema<typename T::value_type>(s);
+  } else if constexpr (binary_structure<T>::value == structure::associative) {
+    s += '{';
+    internal_binary::append_schema<typename T::key_type>(s);
+    internal_binary::append_schema<typename T::mapped_type>(s);
+    s += '}';
+  } else if constexpr (binary_structure<T>::value == structure::sequence) {
+    s += '[';
+    internal_binary::append_schema<
+        std::remove_cvref_t<decltype(*std::begin(std::declval<T&>()))>>(s);
+    s += ']';
+  } else if constexpr (binary_structure<T>::value == structure::object) {
+    constexpr int BaseCount = nth::reflect::base_count<T>;
+    T value{};
+    auto const& names = nth::reflect::field_names<BaseCount>(value);
+    s += '(';
+    nth::reflect::on_fields<BaseCount>(value, [&](auto const&... fields) {
+      size_t i = 0;
+      ((s += names[i++], s += ':',
+        internal_binary::append_schema<std::remove_cvref_t<decltype(fields)>>(
+            s),
+        s += ';'),
+       ...);
+    });
+    s += ')';
+  } else {
+    static_assert(type_is_encodable);
+  }
+}
+
+// A source of bytes to decode from a contiguous buffer.
+struct buffer_source {
+  explicit buffer_source(std::span<std::byte const> bytes) : bytes_(bytes) {}
+
+  bool take(std::span<std::byte> out) {
+    if (out.size() > bytes_.size()) { return false; }
+    std::memcpy(out.data(), bytes_.data(), out.size());
+    bytes_ = bytes_.subspan(out.size());
+    return true;
+  }
+
+  bool take_byte(std::byte& b) {
+    if (bytes_.empty()) { return false; }
+    b      = bytes_.front();
+    bytes_ = bytes_.subspan(1);
+    return true;
+  }
+
+  // Returns whether at least `n` bytes remain, so that corrupt lengths can be
+  // rejected before allocating.
+  bool has(uint64_t n) const { return n <= bytes_.size(); }
+
+  bool exhausted() const { return bytes_.empty(); }
+
+ private:
+  std::span<std::byte const> bytes_;
+};
+
+// A source of bytes to decode from an `io::reader`.
+template <io::reader R>
+struct reader_source {
+  explicit reader_source(R& r) : r_(r) {}
+
+  bool take(std::span<std::byte> out) {
+    return out.empty() or r_.read(out).bytes_read() == out.size();
+  }
+
+  bool take_byte(std::byte& b) { return take(std::span<std::byte>(&b, 1)); }
+
+  bool has(uint64_t n) const {
+    if constexpr (io::sized_reader<R>) {
+      return n <= r_.bytes_remaining();
+    } else {
+      return true;
+    }
+  }
+
+ private:
+  R& r_;
+};
+
+template <typename Source>
+struct decoder {
+  explicit decoder(Source& source) : source_(source) {}
+
+  bool read_varint(uint64_t& n) {
+    n = 0;
+    for (int shift = 0; shift < 7 * MaxVarintSize; shift += 7) {
+      std::byte b;
+      if (not source_.take_byte(b)) { return false; }
+      n |= static_cast<uint64_t>(b & std::byte{0x7f}) << shift;
+      if ((b & std::byte{0x80}) == std::byte{0}) { return true; }
+    }
+    return false;
+  }
+
+  template <std::unsigned_integral U>
+  bool read_little_endian(U& n) {
+    std::byte bytes[sizeof(U)];
+    if (not source_.take(bytes)) { return false; }
+    n = 0;
+    for (size_t i = 0; i < sizeof(U); ++i) {
+      n |= static_cast<U>(static_cast<U>(bytes[i]) << (8 * i));
+    }
+    return true;
+  }
+
+  template <typename T>
+  bool read(T& out) {
+    if constexpr (std::same_as<T, bool>) {
+      std::byte b;
+      if (not source_.take_byte(b) or b > std::byte{1}) { return false; }
+      out = (b == std::byte{1});
+      return true;
+    } else if constexpr (std::integral<T>) {
+      std::make_unsigned_t<T> n;
+      if (not read_little_endian(n)) { return false; }
+      out = static_cast<T>(n);
+      return true;
+    } else if constexpr (std::floating_point<T>) {
+      using bits_type = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+      static_assert(sizeof(T) == sizeof(bits_type));
+      bits_type n;
+      if (not read_little_endian(n)) { return false; }
+      out = std::bit_cast<T>(n);
+      return true;
+    } else if constexpr (std::same_as<T, std::string>) {
+      uint64_t size;
+      if (not read_varint(size) or not source_.has(size)) { return false; }
+      out.resize(size);
+      return source_.take(std::span<std::byte>(
+          reinterpret_cast<std::byte*>(out.data()), out.size()));
+    } else if constexpr (optional_type<T>) {
+      std::byte b;
+      if (not source_.take_byte(b)) { return false; }
+      if (b == std::byte{0}) {
+        out.reset();
+        return true;
+      }
+      return b == std::byte{1} and read(out.emplace());
+    } else if constexpr (binary_structure<T>::value ==
+                         structure::associative) {
+      uint64_t size;
+      if (not read_varint(size)) { return false; }
+      out.clear();
+      for (uint64_t i = 0; i < size; ++i) {
+        typename T::key_type k;
+        typename T::mapped_type v;
+        if (not read(k) or not read(v)) { return false; }
+        out.insert_or_assign(std::move(k), std::move(v));
+      }
+      return true;
+    } else if constexpr (requires(typename T::value_type v) {
+                           out.push_back(std::move(v));
+                         }) {
+      uint64_t size;
+      if (not read_varint(size)) { return false; }
+      out.clear();
+      if constexpr (requires { out.reserve(size); }) {
+        // Every element occupies at least one byte except for objects with no
+        // fields, so a count exceeding the remaining input is only trusted as
+        // far as the input allows.
+        if (source_.has(size)) { out.reserve(size); }
+      }
+      for (uint64_t i = 0; i < size; ++i) {
+        // Decoded separately rather than into `out.emplace_back()`, which for
+        // `std::vector<bool>` is a proxy rather than a reference.
+        typename T::value_type v;
+        if (not read(v)) { return false; }
+        out.push_back(std::move(v));
+      }
+      return true;
+    } else if constexpr (requires(typename T::value_type v) {
+                           out.insert(std::move(v));
+                         }) {
+      uint64_t size;
+      if (not read_varint(size)) { return false; }
+      out.clear();
+      for (uint64_t i = 0; i < size; ++i) {
+        typename T::value_type v;
+        if (not read(v)) { return false; }
+        out.insert(std::move(v));
+      }
+      return true;
+    } else if constexpr (nth::reflectable<T>) {
+      constexpr int BaseCount = nth::reflect::base_count<T>;
+      return nth::reflect::on_fields<BaseCount>(
+          out, [&](auto&... fields) { return (read(fields) and ...); });
+    } else {
+      static_assert(type_is_encodable);
+      return false;
+    }
+  }
+
+ private:
+  Source& source_;
+};
+
+}  // namespace internal_binary
+
+// Options controlling the framing of `binary_encode` and `binary_decode`. Both
+// sides must agree on the options used.
+struct binary_options {
+  // When set, the encoding is prefixed by the eight-byte little-endian
+  // `binary_schema_hash<T>()`, and decoding fails if the hash does not match.
+  bool schema_hash = false;
+};
+
+// Returns a 64-bit FNV-1a hash of the shape of `T`: the kinds and widths of
+// primitives, the nesting of containers, and the names and order of the fields
+// of reflectable types. Encodings of types with equal hashes are (up to hash
+// collisions) interchangeable. The hash is computed once per type. Reflectable
+// types must be default-constructible.
+template <typename T>
+uint64_t binary_schema_hash() {
+  static uint64_t const hash = [] {
+    std::string s;
+    internal_binary::append_schema<T>(s);
+    return nth::fnv1a(s);
+  }();
+  return hash;
+}
+
+// A structural formatter writing values in the compact binary format described
+// at the top of this file.
+struct binary_formatter : structural_formatter<binary_formatter> {
+ private:
+  template <structure S>
+  using cv = nth::constant_value<S>;
+
+ public:
+  template <typename T>
+  static constexpr structure structure_of =
+      internal_binary::binary_structure<T>::value;
+
+  template <typename T>
+  void begin(cv<structure::sequence>, io::writer auto& w, T const& value) {
+    internal_binary::write_varint(
+        w, static_cast<uint64_t>(std::ranges::distance(value)));
+    nesting_.push({.kind = structure::sequence});
+  }
+
+  template <typename T>
+  void begin(cv<structure::associative>, io::writer auto& w, T const& value) {
+    internal_binary::write_varint(
+        w, static_cast<uint64_t>(std::ranges::distance(value)));
+    nesting_.push({.kind = structure::associative});
+  }
+
+  void begin(cv<structure::object>, io::writer auto&) {
+    nesting_.push({.kind = structure::object});
+  }
+
+  void begin(cv<structure::entry>, io::writer auto&) {}
+  void begin(cv<structure::key>, io::writer auto&) {
+    nesting_.top().in_key = true;
+  }
+  void begin(cv<structure::value>, io::writer auto&) {}
+
+  template <typename T>
+  void end(cv<structure::sequence>, io::writer auto&, T const&) {
+    nesting_.pop();
+  }
+  template <typename T>
+  void end(cv<structure::associative>, io::writer auto&, T const&) {
+    nesting_.pop();
+  }
+  void end(cv<structure::object>, io::writer auto&) { nesting_.pop(); }
+  void end(cv<structure::entry>, io::writer auto&) {}
+  void end(cv<structure::key>, io::writer auto&) {
+    nesting_.top().in_key = false;
+  }
+  void end(cv<structure::value>, io::writer auto&) {}
+
+  using structural_formatter::format;
+
+  void format(io::writer auto& w, bool b) {
+    std::byte byte = static_cast<std::byte>(b);
+    w.write(std::span<std::byte const>(&byte, 1));
+  }
+
+  void format(io::writer auto& w, std::integral auto n) {
+    internal_binary::write_little_endian(
+        w, static_cast<std::make_unsigned_t<decltype(n)>>(n));
+  }
+
+  void format(io::writer auto& w, std::floating_point auto x) {
+    using bits_type = std::conditional_t<sizeof(x) == 4, uint32_t, uint64_t>;
+    static_assert(sizeof(x) == sizeof(bits_type));
+    internal_binary::write_little_endian(w, std::bit_cast<bits_type>(x));
+  }
+
+  // Field names of objects are implied by the type being decoded, so they are
+  // not written. Keys of associative containers are written like any other
+  // string.
+  template <nth::explicitly_convertible_to<std::string_view> T>
+  void format(io::writer auto& w, T const& s) {
+    if (not nesting_.empty() and nesting_.top().kind == structure::object and
+        nesting_.top().in_key) {
+      return;
+    }
+    std::string_view sv = static_cast<std::string_view>(s);
+    internal_binary::write_varint(w, sv.size());
+    io::write_text(w, sv);
+  }
+
+  template <typename T>
+  void format(io::writer auto& w, std::optional<T> const& value) {
+    format(w, value.has_value());
+    if (value) { nth::format(w, *this, *value); }
+  }
+
+ private:
+  struct nesting {
+    structure kind;
+    bool in_key = false;
+  };
+  nth::stack<nesting, 8> nesting_;
+};
+
+// Writes `value` to `w` in the compact binary format.
+template <io::writer W, typename T>
+void binary_encode(W& w, T const& value, binary_options options = {}) {
+  if (options.schema_hash) {
+    internal_binary::write_little_endian(w, nth::binary_schema_hash<T>());
+  }
+  nth::format(w, binary_formatter{}, value);
+}
+
+// Decodes a single value produced by `binary_encode` from `input` into `out`.
+// Supported types are `bool`, arithmetic types, `std::string`,
+// `std::optional`, sequences supporting `push_back` or `insert`,
+// associative containers, and types satisfying `nth::reflectable`. Returns
+// whether `input` consists of exactly one well-formed encoding of a `T`. On
+// failure, `out` may have been partially written.
+template <typename T>
+bool binary_decode(std::span<std::byte const> input, T& out,
+                   binary_options options = {}) {
+  internal_binary::buffer_source source(input);
+  internal_binary::decoder d(source);
+  if (options.schema_hash) {
+    uint64_t hash;
+    if (not d.read_little_endian(hash) or
+        hash != nth::binary_schema_hash<T>()) {
+      return false;
+    }
+  }
+  return d.read(out) and source.exhausted();
+}
+
+template <typename T>
+bool binary_decode(std::string_view input, T& out,
+                   binary_options options = {}) {
+  return nth::binary_decode(
+      std::span<std::byte const>(
+          reinterpret_cast<std::byte const*>(input.data()), input.size()),
+      out, options);
+}
+
+// Decodes a single value produced by `binary_encode` from the front of `r`
+// into `out`. Unlike the overloads above, bytes following the value are left
+// unread, so that several values may be decoded from one reader in sequence.
+template <io::reader R, typename T>
+bool binary_decode(R& r, T& out, binary_options options = {}) {
+  internal_binary::reader_source source(r);
+  internal_binary::decoder d(source);
+  if (options.schema_hash) {
+    uint64_t hash;
+    if (not d.read_little_endian(hash) or
+        hash != nth::binary_schema_hash<T>()) {
+      return false;
+    }
+  }
+  return d.read(out);
+}
+
+}  // namespace nth
+
+#endif  // NTH_FORMAT_BINARY_H
@@ -0,0 +1,148 @@
+#include "nth/format/binary.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nth/io/reader/string.h"
+#include "nth/io/writer/string.h"
+#include "nth/test/test.h"
+
+namespace {
+
+template <typename T>
+std::string encode(T const& value, nth::binary_options options = {}) {
+  std::string s;
+  nth::io::string_writer w(s);
+  nth::binary_encode(w, value, options);
+  return s;
+}
+
+NTH_TEST("format/binary/primitive") {
+  NTH_EXPECT(encode(true) == std::string_view("\1", 1));
+  NTH_EXPECT(encode(false) == std::string_view("\0", 1));
+  NTH_EXPECT(encode(int32_t{300}) == std::string_view("\x2c\x01\0\0", 4));
+  NTH_EXPECT(encode(int16_t{-2}) == std::string_view("\xfe\xff", 2));
+  NTH_EXPECT(encode(1.0f) == std::string_view("\0\0\x80\x3f", 4));
+  NTH_EXPECT(encode(std::string("abc")) == std::string_view("\3abc", 4));
+  NTH_EXPECT(encode(std::string(200, 'x')) ==
+             "\xc8\x01" + std::string(200, 'x'));
+}
+
+NTH_TEST("format/binary/containers") {
+  NTH_EXPECT(encode(std::vector<int8_t>{}) == std::string_view("\0", 1));
+  NTH_EXPECT(encode(std::vector<int8_t>{1, 2, 3}) ==
+             std::string_view("\3\1\2\3", 4));
+  NTH_EXPECT(encode(std::map<std::string, bool>{{"a", true}, {"b", false}}) ==
+             std::string_view("\2\1a\1\1b\0", 7));
+  NTH_EXPECT(encode(std::optional<int8_t>()) == std::string_view("\0", 1));
+  NTH_EXPECT(encode(std::optional<int8_t>(5)) == std::string_view("\1\5", 2));
+}
+
+struct Inner {
+  using nth_reflectable = void;
+  bool flag;
+  std::string name;
+};
+
+struct Outer {
+  using nth_reflectable = void;
+  int32_t n;
+  std::optional<std::string> label;
+  std::vector<Inner> inners;
+  std::map<std::string, double> weights;
+  std::set<int16_t> ids;
+};
+
+NTH_TEST("format/binary/reflectable") {
+  // Field names are not written, and disengaged optionals are written as a
+  // single absent byte rather than omitted.
+  NTH_EXPECT(encode(Inner{.flag = true, .name = "x"}) ==
+             std::string_view("\1\1x", 3));
+  NTH_EXPECT(encode(Outer{.n = 1}) ==
+             std::string_view("\1\0\0\0\0\0\0\0", 8));
+}
+
+NTH_TEST("format/binary/round-trip") {
+  Outer o{.n       = -17,
+          .label   = "label",
+          .inners  = {{.flag = true, .name = "x"}, {.flag = false}},
+          .weights = {{"a", 0.5}, {"b", -2}},
+          .ids     = {3, 1, 2}};
+  std::string s = encode(o);
+
+  Outer result;
+  NTH_ASSERT(nth::binary_decode(s, result));
+  NTH_EXPECT(result.n == o.n);
+  NTH_EXPECT(result.label == o.label);
+  NTH_ASSERT(result.inners.size() == o.inners.size());
+  NTH_EXPECT(result.inners[0].flag == o.inners[0].flag);
+  NTH_EXPECT(result.inners[0].name == o.inners[0].name);
+  NTH_EXPECT(result.inners[1].flag == o.inners[1].flag);
+  NTH_EXPECT(result.inners[1].name == o.inners[1].name);
+  NTH_EXPECT(result.weights == o.weights);
+  NTH_EXPECT(result.ids == o.ids);
+}
+
+NTH_TEST("format/binary/round-trip/vector-bool") {
+  std::vector<bool> v = {true, false, false, true, true};
+  NTH_EXPECT(encode(v) == std::string_view("\5\1\0\0\1\1", 6));
+
+  std::vector<bool> result = {false};
+  NTH_ASSERT(nth::binary_decode(encode(v), result));
+  NTH_EXPECT(result == v);
+}
+
+NTH_TEST("format/binary/invalid") {
+  std::vector<int32_t> v;
+  NTH_EXPECT(not nth::binary_decode(std::string_view(""), v));
+  NTH_EXPECT(not nth::binary_decode(std::string_view("\1\0\0\0", 4), v));
+  NTH_EXPECT(not nth::binary_decode(std::string_view("\0\0", 2), v));
+  NTH_EXPECT(not nth::binary_decode(
+      std::string_view("\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 11), v));
+
+  bool b;
+  NTH_EXPECT(not nth::binary_decode(std::string_view("\2", 1), b));
+
+  std::string s;
+  NTH_EXPECT(not nth::binary_decode(std::string_view("\xff\x7f", 2), s));
+}
+
+NTH_TEST("format/binary/schema-hash") {
+  NTH_EXPECT(nth::binary_schema_hash<Outer>() ==
+             nth::binary_schema_hash<Outer>());
+  NTH_EXPECT(nth::binary_schema_hash<Outer>() !=
+             nth::binary_schema_hash<Inner>());
+  NTH_EXPECT(nth::binary_schema_hash<std::vector<int32_t>>() !=
+             nth::binary_schema_hash<std::vector<uint32_t>>());
+
+  Inner i{.flag = true, .name = "name"};
+  std::string s = encode(i, {.schema_hash = true});
+  NTH_EXPECT(s.size() == size_t{8 + 1 + 1 + 4});
+
+  Inner result;
+  NTH_EXPECT(nth::binary_decode(s, result, {.schema_hash = true}));
+  NTH_EXPECT(result.name == "name");
+  NTH_EXPECT(not nth::binary_decode(s, result));
+
+  Outer o;
+  NTH_EXPECT(not nth::binary_decode(s, o, {.schema_hash = true}));
+}
+
+NTH_TEST("format/binary/reader") {
+  std::string s = encode(int32_t{1}) + encode(std::string("two"));
+  nth::io::string_reader r(s);
+  int32_t n;
+  std::string str;
+  NTH_ASSERT(nth::binary_decode(r, n));
+  NTH_ASSERT(nth::binary_decode(r, str));
+  NTH_EXPECT(n == 1);
+  NTH_EXPECT(str == "two");
+  NTH_EXPECT(not nth::binary_decode(r, n));
+}
+
+}  // namespace
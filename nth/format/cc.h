@@ -8,6 +8,7 @@
 #include "nth/format/format.h"
 #include "nth/io/writer/writer.h"
 #include "nth/meta/concepts/convertible.h"
+#include "nth/types/reflect.h"
 #include "nth/types/structure.h"
 
 namespace nth {
@@ -48,6 +49,13 @@ struct cc_structure<T> {
   static constexpr structure value = structure::associative;
 };
 
+template <typename T>
+  requires(nth::reflectable<T> and not seq<T> and
+           nth::reflect::field_count<T, nth::reflect::base_count<T>> >= 0)
+struct cc_structure<T> {
+  static constexpr structure value = structure::object;
+};
+
 }  // namespace internal_cc
 
 struct cc_formatter : structural_formatter<cc_formatter> {
@@ -166,7 +174,7 @@ struct cc_formatter : structural_formatter<cc_formatter> {
     int width;
     bool in_value = false;
   };
-  stack<nesting> nesting_;
+  stack<nesting, 8> nesting_;
 };
 
 }  // namespace nth
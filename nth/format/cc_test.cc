@@ -135,4 +135,18 @@ NTH_TEST("format/cc/object") {
              "}");
 }
 
+struct Reflected {
+  using nth_reflectable = void;
+  int n;
+  std::string s;
+};
+
+NTH_TEST("format/cc/reflectable") {
+  NTH_EXPECT(cc(Reflected{.n = 3, .s = "hi"}) ==
+             "{\n"
+             "  .n = 3,\n"
+             "  .s = \"hi\"\n"
+             "}");
+}
+
 }  // namespace
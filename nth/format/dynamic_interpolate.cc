@@ -0,0 +1,86 @@
+#include "nth/format/dynamic_interpolate.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "nth/base/indestructible.h"
+#include "nth/format/internal/parameter_range.h"
+
+namespace nth {
+namespace {
+
+struct cache {
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::unique_ptr<dynamic_interpolation>>
+      compiled;
+};
+
+cache& global_cache() {
+  static indestructible<cache> c;
+  return *c;
+}
+
+}  // namespace
+
+std::unique_ptr<dynamic_interpolation> dynamic_interpolation::parse(
+    std::string_view s) {
+  if (s.size() > std::numeric_limits<int32_t>::max()) { return nullptr; }
+
+  size_t brace_count = 0;
+  size_t depth       = 0;
+  for (char c : s) {
+    switch (c) {
+      case '{':
+        ++brace_count;
+        ++depth;
+        break;
+      case '}':
+        if (depth == 0) { return nullptr; }
+        --depth;
+        break;
+      default: break;
+    }
+  }
+  if (depth != 0) { return nullptr; }
+
+  auto result   = std::make_unique<dynamic_interpolation>();
+  result->text_ = s;
+  result->tree_.resize(brace_count);
+  std::vector<int32_t> workspace(brace_count);
+  internal_interpolate::populate_tree(result->text_,
+                                      result->tree_.data() + brace_count,
+                                      workspace.data());
+
+  // Top-level placeholders are found by skipping over the subtree of each one.
+  for (size_t i = 0; i < brace_count; i += result->tree_[i].width) {
+    result->placeholders_.push_back(result->tree_[i]);
+  }
+  return result;
+}
+
+dynamic_interpolation const* dynamic_interpolation::compile(
+    std::string_view s) {
+  cache& c = global_cache();
+  {
+    absl::ReaderMutexLock lock(&c.mutex);
+    auto iter = c.compiled.find(s);
+    if (iter != c.compiled.end()) { return iter->second.get(); }
+  }
+
+  // Parse without holding the lock so that concurrent lookups of other strings
+  // are not blocked. If another thread compiled the same string in the
+  // meantime, its result is kept and ours is discarded.
+  std::unique_ptr<dynamic_interpolation> parsed = parse(s);
+  absl::MutexLock lock(&c.mutex);
+  auto [iter, inserted] =
+      c.compiled.try_emplace(std::string(s), std::move(parsed));
+  return iter->second.get();
+}
+
+}  // namespace nth
@@ -0,0 +1,210 @@
+#ifndef NTH_FORMAT_DYNAMIC_INTERPOLATE_H
+#define NTH_FORMAT_DYNAMIC_INTERPOLATE_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "nth/base/attributes.h"
+#include "nth/format/format.h"
+#include "nth/format/internal/parameter_range.h"
+#include "nth/format/interpolate.h"
+#include "nth/io/writer/writer.h"
+#include "nth/meta/type.h"
+
+// This header provides interpolation with interpolation strings only known at
+// runtime (e.g., loaded from a configuration file). Such strings cannot be
+// `nth::interpolation_string`s, which must be known at compile-time, so they
+// are instead parsed at runtime into the same placeholder tree representation.
+// Parsing happens once per distinct string; the result is cached for the
+// lifetime of the program.
+
+namespace nth {
+namespace internal_interpolate {
+
+template <typename T>
+constexpr auto default_dynamic_specs() {
+  if constexpr (std::same_as<T, bool>) {
+    return std::tuple(interpolation_string(""), interpolation_string("b"),
+                      interpolation_string("B"), interpolation_string("B!"),
+                      interpolation_string("d"), interpolation_string("?"));
+  } else if constexpr (std::integral<T>) {
+    return std::tuple(interpolation_string(""), interpolation_string("d"),
+                      interpolation_string("x"), interpolation_string("?"));
+  } else if constexpr (std::same_as<T, std::string> or
+                       std::same_as<T, std::string_view> or
+                       (std::is_array_v<T> and
+                        std::same_as<std::remove_extent_t<T>, char>)) {
+    return std::tuple(interpolation_string(""), interpolation_string("q"),
+                      interpolation_string("?"));
+  } else {
+    return std::tuple(interpolation_string(""));
+  }
+}
+
+// A type-erased `io::writer`, so that formatting functions for type-erased
+// arguments need not be instantiated for every writer.
+struct erased_writer {
+  template <io::writer W>
+  explicit erased_writer(W& w)
+      : writer_(std::addressof(w)),
+        write_([](void* w, std::span<std::byte const> bytes) {
+          return io::basic_write_result(
+              static_cast<W*>(w)->write(bytes).written());
+        }) {}
+
+  io::basic_write_result write(std::span<std::byte const> bytes) {
+    return write_(writer_, bytes);
+  }
+
+ private:
+  void* writer_;
+  io::basic_write_result (*write_)(void*, std::span<std::byte const>);
+};
+
+}  // namespace internal_interpolate
+
+// The contents of placeholders understood when interpolating a value of type
+// `T` into a `dynamic_interpolation`. Because the contents of a placeholder
+// are only known at runtime, only the contents listed here are ever passed to
+// `NthInterpolateFormatter`, each being instantiated ahead of time. By default
+// this is the empty string for all types, along with the options documented
+// for builtin types. Authors of types with their own `NthInterpolateFormatter`
+// may specialize this variable template to a `std::tuple` of
+// `nth::interpolation_string`s to make more options available at runtime.
+template <typename T>
+inline constexpr auto dynamic_interpolation_specs =
+    internal_interpolate::default_dynamic_specs<T>();
+
+// A reference to a value of any type, along with the means to format it
+// according to the contents of a placeholder. A `dynamic_argument` does not
+// extend the lifetime of the value it refers to.
+struct dynamic_argument {
+  template <typename T>
+    requires(not std::same_as<T, dynamic_argument>)
+  dynamic_argument(T const& value NTH_ATTRIBUTE(lifetimebound))
+      : value_(std::addressof(value)),
+        format_(&dynamic_argument::format_as<T>) {}
+
+  // Formats the referenced value to `w` as directed by the contents `spec` of a
+  // placeholder. Returns `false` without writing anything if `spec` is not one
+  // of the `dynamic_interpolation_specs` for the referenced type.
+  bool format(internal_interpolate::erased_writer& w,
+              std::string_view spec) const {
+    return format_(value_, spec, &w);
+  }
+
+  // Returns whether `spec` is one of the `dynamic_interpolation_specs` for the
+  // referenced type.
+  bool accepts(std::string_view spec) const {
+    return format_(value_, spec, nullptr);
+  }
+
+ private:
+  // Formats the value at `ptr` to `w` according to `spec`, or only checks that
+  // `spec` is understood if `w` is null.
+  template <typename T>
+  static bool format_as(void const* ptr, std::string_view spec,
+                        internal_interpolate::erased_writer* w) {
+    T const& value = *static_cast<T const*>(ptr);
+    return [&]<size_t... Ns>(std::index_sequence<Ns...>) {
+      return (... or
+              (spec == static_cast<std::string_view>(
+                           std::get<Ns>(dynamic_interpolation_specs<T>)) and
+               (w == nullptr or
+                (nth::format(*w,
+                             NthInterpolateFormatter<std::get<Ns>(
+                                 dynamic_interpolation_specs<T>)>(nth::type<T>),
+                             value),
+                 true))));
+    }(std::make_index_sequence<std::tuple_size_v<
+          std::remove_cvref_t<decltype(dynamic_interpolation_specs<T>)>>>{});
+  }
+
+  void const* value_;
+  bool (*format_)(void const*, std::string_view,
+                  internal_interpolate::erased_writer*);
+};
+
+// The compiled form of an interpolation string parsed at runtime. The syntax
+// is identical to that of `nth::interpolation_string`.
+struct dynamic_interpolation {
+  // Returns the compiled form of `s`, or null if the braces in `s` are not
+  // balanced. The first call for any given string parses it and caches the
+  // result; subsequent calls (from any thread) return the same object. The
+  // returned pointer is valid for the remainder of the program.
+  static dynamic_interpolation const* compile(std::string_view s);
+
+  // Parses `s` without consulting or populating the cache. Returns null if the
+  // braces in `s` are not balanced.
+  static std::unique_ptr<dynamic_interpolation> parse(std::string_view s);
+
+  // The number of placeholders in this interpolation string.
+  size_t placeholders() const { return placeholders_.size(); }
+
+  operator std::string_view() const { return text_; }
+
+  // Writes the interpolation string to `w`, formatting each element of `args`
+  // into the corresponding placeholder. Returns `false` if the number of
+  // arguments does not match the number of placeholders or if any placeholder's
+  // contents are not understood by the type of the corresponding argument. In
+  // that case, nothing is written.
+  template <io::writer W>
+  bool interpolate(W& w, std::span<dynamic_argument const> args) const;
+
+  template <io::writer W, typename... Ts>
+  bool interpolate(W& w, Ts const&... values) const {
+    std::array<dynamic_argument, sizeof...(Ts)> args{
+        dynamic_argument(values)...};
+    return interpolate(w, std::span<dynamic_argument const>(args));
+  }
+
+ private:
+  std::string text_;
+  std::vector<internal_interpolate::parameter_range> tree_;
+  std::vector<internal_interpolate::parameter_range> placeholders_;
+};
+
+template <io::writer W>
+bool dynamic_interpolation::interpolate(
+    W& w, std::span<dynamic_argument const> args) const {
+  if (args.size() != placeholders_.size()) { return false; }
+  std::string_view text = text_;
+  for (size_t i = 0; i < args.size(); ++i) {
+    auto const& r = placeholders_[i];
+    if (not args[i].accepts(text.substr(r.start, r.length))) { return false; }
+  }
+
+  internal_interpolate::erased_writer erased(w);
+  size_t start = 0;
+  for (size_t i = 0; i < args.size(); ++i) {
+    auto const& r = placeholders_[i];
+    io::write_text(w, text.substr(start, r.start - 1 - start));
+    args[i].format(erased, text.substr(r.start, r.length));
+    start = r.end() + 1;
+  }
+  io::write_text(w, text.substr(start));
+  return true;
+}
+
+// Interpolates `values` into the runtime interpolation string `s`, as if by
+// `dynamic_interpolation::compile(s)->interpolate(w, values...)`. Returns
+// `false` without writing anything if `s` is not a valid interpolation string
+// or if the values do not match its placeholders.
+template <io::writer W, typename... Ts>
+bool dynamic_interpolate(W& w, std::string_view s, Ts const&... values) {
+  dynamic_interpolation const* compiled = dynamic_interpolation::compile(s);
+  return compiled and compiled->interpolate(w, values...);
+}
+
+}  // namespace nth
+
+#endif  // NTH_FORMAT_DYNAMIC_INTERPOLATE_H
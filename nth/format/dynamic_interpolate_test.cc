@@ -0,0 +1,78 @@
+#include "nth/format/dynamic_interpolate.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nth/io/writer/string.h"
+#include "nth/test/test.h"
+
+namespace {
+
+template <typename... Ts>
+std::optional<std::string> interpolate(std::string_view s,
+                                       Ts const&... values) {
+  std::string result;
+  nth::io::string_writer w(result);
+  if (not nth::dynamic_interpolate(w, s, values...)) { return std::nullopt; }
+  return result;
+}
+
+NTH_TEST("dynamic_interpolate/basic") {
+  NTH_EXPECT(interpolate("") == "");
+  NTH_EXPECT(interpolate("no placeholders") == "no placeholders");
+  NTH_EXPECT(interpolate("abc{}def", "xyz") == "abcxyzdef");
+  NTH_EXPECT(interpolate("{} + {} = {}", 1, 2, 3) == "1 + 2 = 3");
+}
+
+NTH_TEST("dynamic_interpolate/builtin-options") {
+  NTH_EXPECT(interpolate("{x}", 255) == "ff");
+  NTH_EXPECT(interpolate("{d}", 255) == "255");
+  NTH_EXPECT(interpolate("{q}", std::string("a\"b")) == R"("a\"b")");
+  NTH_EXPECT(interpolate("{q}", std::string_view("a\nb")) == R"("a\nb")");
+  NTH_EXPECT(interpolate("{B} {B!} {d}", true, false, true) ==
+             "True FALSE 1");
+}
+
+NTH_TEST("dynamic_interpolate/invalid") {
+  NTH_EXPECT(interpolate("{", 1) == std::nullopt);
+  NTH_EXPECT(interpolate("}{", 1) == std::nullopt);
+  NTH_EXPECT(interpolate("{}}", 1) == std::nullopt);
+  NTH_EXPECT(interpolate("{} {}", 1) == std::nullopt);
+  NTH_EXPECT(interpolate("{}", 1, 2) == std::nullopt);
+  NTH_EXPECT(interpolate("{} {y}", 1, 2) == std::nullopt);
+  NTH_EXPECT(interpolate("{x}", std::string("abc")) == std::nullopt);
+}
+
+NTH_TEST("dynamic_interpolate/nested") {
+  auto const* compiled =
+      nth::dynamic_interpolation::compile("[{{a}{b}}] [{}]");
+  NTH_ASSERT(compiled != nullptr);
+  NTH_EXPECT(compiled->placeholders() == size_t{2});
+}
+
+NTH_TEST("dynamic_interpolate/cached") {
+  std::string s        = "value: {}";
+  auto const* compiled = nth::dynamic_interpolation::compile(s);
+  NTH_ASSERT(compiled != nullptr);
+  NTH_EXPECT(nth::dynamic_interpolation::compile(std::string(s)) == compiled);
+  NTH_EXPECT(nth::dynamic_interpolation::compile("{") == nullptr);
+  NTH_EXPECT(nth::dynamic_interpolation::compile("{") == nullptr);
+}
+
+NTH_TEST("dynamic_interpolate/argument-span") {
+  int n            = 3;
+  std::string name = "name";
+  std::vector<nth::dynamic_argument> args{n, name};
+
+  std::string result;
+  nth::io::string_writer w(result);
+  auto const* compiled = nth::dynamic_interpolation::compile("{}: {q}");
+  NTH_ASSERT(compiled != nullptr);
+  NTH_ASSERT(compiled->interpolate(
+      w, std::span<nth::dynamic_argument const>(args)));
+  NTH_EXPECT(result == R"(3: "name")");
+}
+
+}  // namespace
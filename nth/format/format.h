@@ -1,7 +1,9 @@
 #ifndef NTH_FORMAT_FORMAT_H
 #define NTH_FORMAT_FORMAT_H
 
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "nth/format/common_defaults.h"
 #include "nth/format/common_formatters.h"
@@ -11,6 +13,7 @@
 #include "nth/io/writer/writer.h"
 #include "nth/meta/constant.h"
 #include "nth/meta/type.h"
+#include "nth/types/reflect.h"
 #include "nth/types/structure.h"
 
 // This header file defines a mechanism by which one can register format
@@ -62,6 +65,30 @@ decltype(auto) end_format(io::writer auto& w, F& f) {
   }
 }
 
+// Formatters may also implement `begin` and `end` member functions accepting
+// the value being formatted as a third argument, for structures where the
+// formatter needs to see the value itself (e.g., to write the number of
+// elements in a sequence before any of the elements). These overloads prefer
+// such member functions when they exist and otherwise fall back to the
+// two-argument forms above.
+template <nth::structure S, int&..., typename F>
+decltype(auto) begin_format(io::writer auto& w, F& f, auto const& value) {
+  if constexpr (requires { f.begin(nth::constant<S>, w, value); }) {
+    return f.begin(nth::constant<S>, w, value);
+  } else {
+    return nth::begin_format<S>(w, f);
+  }
+}
+
+template <nth::structure S, int&..., typename F>
+decltype(auto) end_format(io::writer auto& w, F& f, auto const& value) {
+  if constexpr (requires { f.end(nth::constant<S>, w, value); }) {
+    return f.end(nth::constant<S>, w, value);
+  } else {
+    return nth::end_format<S>(w, f);
+  }
+}
+
 void format_key_value(io::writer auto& w, auto& fmt, auto const& key,
                       auto const& value) {
   nth::begin_format<nth::structure::key>(w, fmt);
@@ -72,6 +99,28 @@ void format_key_value(io::writer auto& w, auto& fmt, auto const& key,
   nth::end_format<nth::structure::value>(w, fmt);
 }
 
+namespace internal_format {
+
+void format_field(io::writer auto& w, auto& fmt, std::string_view name,
+                  auto const& value) {
+  nth::format_key_value(w, fmt, name, value);
+}
+
+// Disengaged optional fields are omitted entirely rather than formatted, unless
+// the formatter knows how to format the optional itself.
+template <typename T>
+void format_field(io::writer auto& w, auto& fmt, std::string_view name,
+                  std::optional<T> const& value) {
+  if constexpr (requires { fmt.format(w, value); }) {
+    nth::format_key_value(w, fmt, name, value);
+  } else {
+    if (not value) { return; }
+    nth::format_key_value(w, fmt, name, *value);
+  }
+}
+
+}  // namespace internal_format
+
 // `structural_formatter` is a CRTP base-class that can be used to simplify
 // formatting of objects which have a well-understood structure that is visible
 // in the object being formatted. Users may implement begin/end pairs of member
@@ -83,20 +132,20 @@ struct structural_formatter {
   void format(io::writer auto& w, T const& value)
     requires(F::template structure_of<T> == structure::sequence)
   {
-    begin_format<structure::sequence>(w, self());
+    begin_format<structure::sequence>(w, self(), value);
     for (auto const& element : value) {
       begin_format<structure::entry>(w, self());
       nth::format(w, self(), element);
       end_format<structure::entry>(w, self());
     }
-    end_format<structure::sequence>(w, self());
+    end_format<structure::sequence>(w, self(), value);
   }
 
   template <typename T>
   void format(io::writer auto& w, T const& value)
     requires(F::template structure_of<T> == structure::associative)
   {
-    begin_format<structure::associative>(w, self());
+    begin_format<structure::associative>(w, self(), value);
     for (auto const& [k, v] : value) {
       begin_format<structure::key>(w, self());
       nth::format(w, self(), k);
@@ -106,7 +155,26 @@ struct structural_formatter {
       nth::format(w, self(), v);
       end_format<structure::value>(w, self());
     }
-    end_format<structure::associative>(w, self());
+    end_format<structure::associative>(w, self(), value);
+  }
+
+  // Reflectable types are formatted as objects keyed on their field names. The
+  // number and types of fields are known statically, so this expands to a
+  // fixed sequence of key/value writes with no per-field dispatch. Types which
+  // provide their own `NthFormat` take precedence over this overload.
+  template <nth::reflectable T, io::writer W>
+  void format(W& w, T const& value)
+    requires(F::template structure_of<T> == structure::object and
+             not nth::formattable_with_ftadle<T, W, F>)
+  {
+    constexpr int BaseCount = nth::reflect::base_count<T>;
+    std::string_view const* name =
+        nth::reflect::field_names<BaseCount>(value).data();
+    begin_format<structure::object>(w, self());
+    nth::reflect::on_fields<BaseCount>(value, [&](auto const&... fields) {
+      (internal_format::format_field(w, self(), *name++, fields), ...);
+    });
+    end_format<structure::object>(w, self());
   }
 
  private:
@@ -0,0 +1,321 @@
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "nth/format/common_formatters.h"
+#include "nth/format/format.h"
+#include "nth/format/interpolate.h"
+#include "nth/format/json.h"
+#include "nth/io/writer/string.h"
+#include "nth/meta/compile_time_string.h"
+#include "nth/test/benchmark.h"
+#include "nth/test/benchmark_result.h"
+#include "nth/test/test.h"
+
+// Benchmarks for the format library. Each case appends its output to a
+// `std::string` which is cleared (without releasing its capacity) between
+// iterations, so the measurements reflect formatting cost rather than
+// allocation. Where a comparable facility exists, `std::format` and `snprintf`
+// baselines producing the same output are measured alongside. Results are
+// reported as the mean time per operation (in nanoseconds) along with the
+// number of bytes each operation produces.
+
+namespace {
+
+std::map<std::string_view, size_t>& bytes_per_op() {
+  static std::map<std::string_view, size_t> bytes;
+  return bytes;
+}
+
+void report(nth::test::BenchmarkResult const& result) {
+  auto iter = bytes_per_op().find(result.name);
+  std::printf("%-36.*s %10.1f ns/op %6zu bytes/op\n",
+              static_cast<int>(result.name.size()), result.name.data(),
+              result.mean, iter == bytes_per_op().end() ? 0 : iter->second);
+}
+
+void register_report() {
+  [[maybe_unused]] static bool const registered =
+      (nth::test::RegisterBenchmarkResultHandler(report), true);
+}
+
+// Measures `f`, which must append the formatted result to the `std::string`
+// passed to it, under the timer `Name`.
+template <nth::compile_time_string Name>
+void benchmark(auto f) {
+  register_report();
+  std::string s;
+  f(s);
+  bytes_per_op()[static_cast<std::string_view>(Name)] = s.size();
+  NTH_MEASURE() {
+    s.clear();
+    NTH_TIME(Name) {
+      f(s);
+      nth::DoNotOptimize(s);
+    }
+  }
+}
+
+NTH_TEST("format/benchmark/interpolate") {
+  int a = 1, b = -23, c = 456, d = -7890, e = 12345, f = -678901, g = 2345678,
+      h = -90123456;
+  for (int* n : {&a, &b, &c, &d, &e, &f, &g, &h}) { nth::DoNotOptimize(*n); }
+
+  benchmark<"interpolate/0">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"request completed">(w);
+  });
+  benchmark<"interpolate/1">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"request {} completed">(w, a);
+  });
+  benchmark<"interpolate/2">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"request {} completed in {}">(w, a, b);
+  });
+  benchmark<"interpolate/4">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"request {} completed in {} ({}, {})">(w, a, b, c, d);
+  });
+  benchmark<"interpolate/8">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"{} {} {} {}: request {} completed in {} ({}, {})">(
+        w, a, b, c, d, e, f, g, h);
+  });
+
+  benchmark<"std::format/0">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "request completed");
+  });
+  benchmark<"std::format/1">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "request {} completed", a);
+  });
+  benchmark<"std::format/2">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "request {} completed in {}", a, b);
+  });
+  benchmark<"std::format/4">([&](std::string& s) {
+    std::format_to(std::back_inserter(s),
+                   "request {} completed in {} ({}, {})", a, b, c, d);
+  });
+  benchmark<"std::format/8">([&](std::string& s) {
+    std::format_to(std::back_inserter(s),
+                   "{} {} {} {}: request {} completed in {} ({}, {})", a, b,
+                   c, d, e, f, g, h);
+  });
+
+  benchmark<"snprintf/0">([&](std::string& s) {
+    char buffer[128];
+    s.append(buffer,
+             std::snprintf(buffer, sizeof(buffer), "request completed"));
+  });
+  benchmark<"snprintf/1">([&](std::string& s) {
+    char buffer[128];
+    s.append(buffer,
+             std::snprintf(buffer, sizeof(buffer), "request %d completed", a));
+  });
+  benchmark<"snprintf/2">([&](std::string& s) {
+    char buffer[128];
+    s.append(buffer, std::snprintf(buffer, sizeof(buffer),
+                                   "request %d completed in %d", a, b));
+  });
+  benchmark<"snprintf/4">([&](std::string& s) {
+    char buffer[128];
+    s.append(buffer,
+             std::snprintf(buffer, sizeof(buffer),
+                           "request %d completed in %d (%d, %d)", a, b, c, d));
+  });
+  benchmark<"snprintf/8">([&](std::string& s) {
+    char buffer[128];
+    s.append(buffer, std::snprintf(
+                         buffer, sizeof(buffer),
+                         "%d %d %d %d: request %d completed in %d (%d, %d)", a,
+                         b, c, d, e, f, g, h));
+  });
+}
+
+NTH_TEST("format/benchmark/integer") {
+  int8_t i8      = std::numeric_limits<int8_t>::min();
+  int16_t i16    = std::numeric_limits<int16_t>::min();
+  int32_t i32    = std::numeric_limits<int32_t>::min();
+  int64_t i64    = std::numeric_limits<int64_t>::min();
+  uint64_t small = 7;
+  nth::DoNotOptimize(i8);
+  nth::DoNotOptimize(i16);
+  nth::DoNotOptimize(i32);
+  nth::DoNotOptimize(i64);
+  nth::DoNotOptimize(small);
+
+  benchmark<"format/int8">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, i8);
+  });
+  benchmark<"format/int16">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, i16);
+  });
+  benchmark<"format/int32">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, i32);
+  });
+  benchmark<"format/int64">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, i64);
+  });
+  benchmark<"format/uint64-small">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, small);
+  });
+  benchmark<"format/int64-hex">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, nth::base_formatter(16), i64);
+  });
+
+  benchmark<"std::format/int8">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", i8);
+  });
+  benchmark<"std::format/int16">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", i16);
+  });
+  benchmark<"std::format/int32">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", i32);
+  });
+  benchmark<"std::format/int64">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", i64);
+  });
+  benchmark<"std::format/uint64-small">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", small);
+  });
+
+  benchmark<"snprintf/int32">([&](std::string& s) {
+    char buffer[32];
+    s.append(buffer, std::snprintf(buffer, sizeof(buffer), "%" PRId32, i32));
+  });
+  benchmark<"snprintf/int64">([&](std::string& s) {
+    char buffer[32];
+    s.append(buffer, std::snprintf(buffer, sizeof(buffer), "%" PRId64, i64));
+  });
+}
+
+NTH_TEST("format/benchmark/float") {
+  double x = 3.14159265358979;
+  double y = -1.5e-300;
+  nth::DoNotOptimize(x);
+  nth::DoNotOptimize(y);
+
+  benchmark<"format/double">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, x);
+  });
+  benchmark<"format/double-tiny">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, y);
+  });
+  benchmark<"std::format/double">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", x);
+  });
+  benchmark<"std::format/double-tiny">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "{}", y);
+  });
+  benchmark<"snprintf/double">([&](std::string& s) {
+    char buffer[64];
+    s.append(buffer, std::snprintf(buffer, sizeof(buffer), "%.17g", x));
+  });
+}
+
+NTH_TEST("format/benchmark/quoted-string") {
+  std::string plain   = "the quick brown fox jumps over the lazy dog";
+  std::string escaped = "line one\n\"quoted\"\ttab\\backslash\x01 end";
+
+  benchmark<"format/quote-plain">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, nth::quote_formatter{}, plain);
+  });
+  benchmark<"format/quote-escaped">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, nth::quote_formatter{}, escaped);
+  });
+  benchmark<"interpolate/quote-escaped">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::interpolate<"value = {q}">(w, escaped);
+  });
+  // `std::format` has no escaping presentation prior to C++23, so this
+  // baseline only wraps the string in quotation marks and serves as a lower
+  // bound.
+  benchmark<"std::format/quote-plain">([&](std::string& s) {
+    std::format_to(std::back_inserter(s), "\"{}\"", plain);
+  });
+}
+
+NTH_TEST("format/benchmark/container") {
+  std::vector<std::vector<int>> nested;
+  for (int i = 0; i < 16; ++i) {
+    auto& row = nested.emplace_back();
+    for (int j = 0; j < 16; ++j) { row.push_back(i * 1000 + j); }
+  }
+
+  benchmark<"format/container">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::container_formatter inner("[", ", ", "]", nth::base_formatter(10));
+    nth::format(w,
+                nth::container_formatter("[", ", ", "]", std::move(inner)),
+                nested);
+  });
+  benchmark<"std::format/container">([&](std::string& s) {
+    auto out = std::back_inserter(s);
+    *out++   = '[';
+    std::string_view outer_separator = "";
+    for (auto const& row : nested) {
+      out = std::format_to(out, "{}[", std::exchange(outer_separator, ", "));
+      std::string_view separator = "";
+      for (int n : row) {
+        out = std::format_to(out, "{}{}", std::exchange(separator, ", "), n);
+      }
+      *out++ = ']';
+    }
+    *out++ = ']';
+  });
+}
+
+struct Record {
+  using nth_reflectable = void;
+  int64_t id;
+  std::string name;
+  double score;
+  std::vector<int> tags;
+  std::map<std::string, std::string> attributes;
+};
+
+NTH_TEST("format/benchmark/json") {
+  std::vector<Record> records;
+  for (int i = 0; i < 16; ++i) {
+    records.push_back({.id         = i * 7919,
+                       .name       = "record \"" + std::to_string(i) + "\"",
+                       .score      = i * 0.25,
+                       .tags       = {i, i + 1, i + 2},
+                       .attributes = {{"owner", "team-" + std::to_string(i)},
+                                      {"region", "us-east"}}});
+  }
+  std::map<std::string, std::vector<int>> map;
+  for (int i = 0; i < 16; ++i) {
+    map["key" + std::to_string(i)] = {i, 2 * i, 3 * i};
+  }
+
+  benchmark<"json/records">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, nth::json_formatter{}, records);
+  });
+  benchmark<"json/map">([&](std::string& s) {
+    nth::io::string_writer w(s);
+    nth::format(w, nth::json_formatter{}, map);
+  });
+}
+
+}  // namespace
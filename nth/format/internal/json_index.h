@@ -0,0 +1,100 @@
+#ifndef NTH_FORMAT_INTERNAL_JSON_INDEX_H
+#define NTH_FORMAT_INTERNAL_JSON_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nth::internal_json {
+
+// Stage one of parsing: Scans `input` in 64-byte blocks, computing bitmasks of
+// quotes, backslashes, whitespace and structural characters for each block and
+// combining them with branch-free bit manipulation to determine which bytes
+// are inside strings. The offsets of every unescaped quote, every structural
+// character (`{}[]:,`) outside of a string, and the first byte of every
+// scalar (numbers, `true`, `false`, and `null`) are appended to `index` in
+// increasing order. Returns `false` if `input` contains an unterminated string
+// or an unescaped control character inside a string, or if `input` is too
+// large to be indexed with 32-bit offsets.
+bool structural_index(std::string_view input, std::vector<uint32_t>& index);
+
+// Returns whether `s` matches the JSON grammar for numbers.
+bool valid_number(std::string_view s);
+
+// Decodes the escape sequences in the contents `raw` of a JSON string (not
+// including the surrounding quotation marks), appending the result to `out`.
+// Returns `false` if `raw` contains an invalid escape sequence.
+bool unescape(std::string_view raw, std::string& out);
+
+struct token {
+  enum kind_type : uint8_t {
+    begin_object,
+    end_object,
+    begin_array,
+    end_array,
+    colon,
+    comma,
+    string,
+    scalar,
+    end,
+    error,
+  };
+
+  kind_type kind;
+
+  // For `string` tokens, the raw (still escaped) contents between the
+  // quotation marks. For `scalar` tokens, the lexeme with trailing whitespace
+  // removed. Empty otherwise.
+  std::string_view text;
+};
+
+// Stage two of parsing: Walks the structural index produced by
+// `structural_index`, producing one token at a time without ever looking at
+// the bytes between indexed positions (other than to trim whitespace trailing
+// a scalar).
+struct tokenizer {
+  explicit tokenizer(std::string_view input, std::vector<uint32_t> const& index)
+      : input_(input),
+        next_(index.data()),
+        end_(index.data() + index.size()) {}
+
+  token next() {
+    if (next_ == end_) { return {.kind = token::end}; }
+    uint32_t position = *next_++;
+    switch (input_[position]) {
+      case '{': return {.kind = token::begin_object};
+      case '}': return {.kind = token::end_object};
+      case '[': return {.kind = token::begin_array};
+      case ']': return {.kind = token::end_array};
+      case ':': return {.kind = token::colon};
+      case ',': return {.kind = token::comma};
+      case '"': {
+        // Quotes are always indexed in pairs, so the closing quote is next.
+        uint32_t close = *next_++;
+        return {.kind = token::string,
+                .text = input_.substr(position + 1, close - position - 1)};
+      }
+      default: {
+        size_t stop = (next_ == end_) ? input_.size() : *next_;
+        while (stop > position and is_whitespace(input_[stop - 1])) { --stop; }
+        return {.kind = token::scalar,
+                .text = input_.substr(position, stop - position)};
+      }
+    }
+  }
+
+ private:
+  static constexpr bool is_whitespace(char c) {
+    return c == ' ' or c == '\t' or c == '\n' or c == '\r';
+  }
+
+  std::string_view input_;
+  uint32_t const* next_;
+  uint32_t const* end_;
+};
+
+}  // namespace nth::internal_json
+
+#endif  // NTH_FORMAT_INTERNAL_JSON_INDEX_H
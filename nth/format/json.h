@@ -8,6 +8,7 @@
 #include "nth/format/format.h"
 #include "nth/io/writer/writer.h"
 #include "nth/meta/concepts/convertible.h"
+#include "nth/types/reflect.h"
 #include "nth/types/structure.h"
 
 namespace nth {
@@ -48,6 +49,13 @@ struct json_structure<T> {
   static constexpr structure value = structure::associative;
 };
 
+template <typename T>
+  requires(nth::reflectable<T> and not seq<T> and
+           nth::reflect::field_count<T, nth::reflect::base_count<T>> >= 0)
+struct json_structure<T> {
+  static constexpr structure value = structure::object;
+};
+
 }  // namespace internal_json
 
 struct json_formatter : structural_formatter<json_formatter> {
@@ -134,7 +142,7 @@ struct json_formatter : structural_formatter<json_formatter> {
     char close[2];
     int width;
   };
-  nth::stack<nesting> nesting_;
+  nth::stack<nesting, 8> nesting_;
 };
 
 }  // namespace nth
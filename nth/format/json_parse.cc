@@ -0,0 +1,280 @@
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nth/base/platform.h"
+#include "nth/format/internal/json_index.h"
+
+#if NTH_ARCHITECTURE(x64)
+#include <emmintrin.h>
+#endif  // NTH_ARCHITECTURE(x64)
+
+namespace nth::internal_json {
+namespace {
+
+// One bit per byte of a 64-byte block, indicating whether the byte is of the
+// given character class.
+struct block_masks {
+  uint64_t backslash  = 0;
+  uint64_t quote      = 0;
+  uint64_t whitespace = 0;
+  uint64_t structural = 0;
+  uint64_t control    = 0;
+};
+
+#if NTH_ARCHITECTURE(x64)
+
+// SSE2 is part of the x86-64 baseline, so no runtime dispatch is necessary.
+block_masks classify(char const* block) {
+  block_masks m;
+  for (int i = 0; i < 4; ++i) {
+    __m128i v =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + 16 * i));
+    int shift = 16 * i;
+    auto bits = [&](__m128i matches) {
+      return static_cast<uint64_t>(
+                 static_cast<uint16_t>(_mm_movemask_epi8(matches)))
+             << shift;
+    };
+    auto eq = [&](char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+
+    m.backslash |= bits(eq('\\'));
+    m.quote |= bits(eq('"'));
+    m.whitespace |= bits(_mm_or_si128(_mm_or_si128(eq(' '), eq('\t')),
+                                      _mm_or_si128(eq('\n'), eq('\r'))));
+    m.structural |= bits(_mm_or_si128(
+        _mm_or_si128(_mm_or_si128(eq('{'), eq('}')),
+                     _mm_or_si128(eq('['), eq(']'))),
+        _mm_or_si128(eq(':'), eq(','))));
+    // Bytes which are unsigned-less-than 0x20 are exactly those unchanged by an
+    // unsigned minimum with 0x1f.
+    m.control |=
+        bits(_mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+  }
+  return m;
+}
+
+#else
+
+block_masks classify(char const* block) {
+  block_masks m;
+  for (int i = 0; i < 64; ++i) {
+    uint64_t bit    = uint64_t{1} << i;
+    unsigned char c = static_cast<unsigned char>(block[i]);
+    switch (c) {
+      case '\\': m.backslash |= bit; break;
+      case '"': m.quote |= bit; break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r': m.whitespace |= bit; break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',': m.structural |= bit; break;
+      default: break;
+    }
+    if (c < 0x20) { m.control |= bit; }
+  }
+  return m;
+}
+
+#endif  // NTH_ARCHITECTURE(x64)
+
+// Returns a mask whose `i`th bit is the exclusive-or of bits `0` through `i`
+// of `n`. Applied to a mask of quotes, this yields the bytes within strings.
+constexpr uint64_t prefix_xor(uint64_t n) {
+  n ^= n << 1;
+  n ^= n << 2;
+  n ^= n << 4;
+  n ^= n << 8;
+  n ^= n << 16;
+  n ^= n << 32;
+  return n;
+}
+
+// Returns the mask of bytes escaped by a preceding backslash. A byte is
+// escaped exactly when it follows an odd-length run of backslashes. Runs are
+// split into those starting on even and odd bit positions and the carry out of
+// an addition is used to find where each run ends. `prev_escaped` carries
+// whether the first byte of the next block is escaped.
+uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+  constexpr uint64_t EvenBits = 0x5555555555555555;
+
+  backslash &= ~prev_escaped;
+  uint64_t follows_escape      = (backslash << 1) | prev_escaped;
+  uint64_t odd_sequence_starts = backslash & ~EvenBits & ~follows_escape;
+  uint64_t sequences_starting_on_even_bits;
+  prev_escaped = __builtin_add_overflow(odd_sequence_starts, backslash,
+                                        &sequences_starting_on_even_bits);
+  uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+  return (EvenBits ^ invert_mask) & follows_escape;
+}
+
+constexpr bool is_digit(char c) { return c >= '0' and c <= '9'; }
+
+constexpr int hex_value(char c) {
+  if (c >= '0' and c <= '9') { return c - '0'; }
+  if (c >= 'a' and c <= 'f') { return c - 'a' + 10; }
+  if (c >= 'A' and c <= 'F') { return c - 'A' + 10; }
+  return -1;
+}
+
+// Consumes four hexadecimal digits from the front of `s`, returning their
+// value or -1 if they are not present.
+int32_t consume_code_unit(std::string_view& s) {
+  if (s.size() < 4) { return -1; }
+  int32_t result = 0;
+  for (int i = 0; i < 4; ++i) {
+    int digit = hex_value(s[i]);
+    if (digit < 0) { return -1; }
+    result = (result << 4) | digit;
+  }
+  s.remove_prefix(4);
+  return result;
+}
+
+void append_utf8(uint32_t code_point, std::string& out) {
+  if (code_point < 0x80) {
+    out.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    out.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+}  // namespace
+
+bool structural_index(std::string_view input, std::vector<uint32_t>& index) {
+  if (input.size() > std::numeric_limits<uint32_t>::max()) { return false; }
+
+  uint64_t prev_escaped   = 0;
+  uint64_t prev_in_string = 0;
+  uint64_t prev_scalar    = 0;
+  uint64_t errors         = 0;
+
+  auto process = [&](char const* block, uint32_t offset) {
+    block_masks m      = classify(block);
+    uint64_t escaped   = find_escaped(m.backslash, prev_escaped);
+    uint64_t quote     = m.quote & ~escaped;
+    uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+    prev_in_string =
+        static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+    errors |= m.control & in_string;
+
+    // Opening quotes are in `in_string` but closing quotes are not, so both
+    // must be removed to find the bytes outside of strings.
+    uint64_t outside      = ~in_string & ~quote;
+    uint64_t scalar       = outside & ~(m.structural | m.whitespace);
+    uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+    prev_scalar           = scalar >> 63;
+
+    uint64_t bits = (m.structural & outside) | quote | scalar_start;
+    size_t size   = index.size();
+    index.resize(size + std::popcount(bits));
+    uint32_t* out = index.data() + size;
+    for (; bits != 0; bits &= bits - 1) {
+      *out++ = offset + std::countr_zero(bits);
+    }
+  };
+
+  size_t offset = 0;
+  for (; offset + 64 <= input.size(); offset += 64) {
+    process(input.data() + offset, offset);
+  }
+  if (offset != input.size()) {
+    char block[64];
+    std::memset(block, ' ', 64);
+    std::memcpy(block, input.data() + offset, input.size() - offset);
+    process(block, offset);
+  }
+
+  return errors == 0 and prev_in_string == 0;
+}
+
+bool valid_number(std::string_view s) {
+  char const* p = s.data();
+  char const* e = p + s.size();
+  if (p != e and *p == '-') { ++p; }
+  if (p == e) { return false; }
+  if (*p == '0') {
+    ++p;
+  } else if (is_digit(*p)) {
+    while (++p != e and is_digit(*p)) {}
+  } else {
+    return false;
+  }
+
+  if (p != e and *p == '.') {
+    if (++p == e or not is_digit(*p)) { return false; }
+    while (++p != e and is_digit(*p)) {}
+  }
+
+  if (p != e and (*p == 'e' or *p == 'E')) {
+    if (++p != e and (*p == '+' or *p == '-')) { ++p; }
+    if (p == e or not is_digit(*p)) { return false; }
+    while (++p != e and is_digit(*p)) {}
+  }
+  return p == e;
+}
+
+bool unescape(std::string_view raw, std::string& out) {
+  while (true) {
+    size_t i = raw.find('\\');
+    if (i == std::string_view::npos) {
+      out.append(raw);
+      return true;
+    }
+    out.append(raw.substr(0, i));
+    raw.remove_prefix(i + 1);
+    if (raw.empty()) { return false; }
+    char c = raw[0];
+    raw.remove_prefix(1);
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/': out.push_back(c); break;
+      case 'b': out.push_back('\b'); break;
+      case 'f': out.push_back('\f'); break;
+      case 'n': out.push_back('\n'); break;
+      case 'r': out.push_back('\r'); break;
+      case 't': out.push_back('\t'); break;
+      case 'u': {
+        int32_t unit = consume_code_unit(raw);
+        if (unit < 0) { return false; }
+        uint32_t code_point = unit;
+        if (unit >= 0xd800 and unit < 0xdc00) {
+          // A high surrogate must be immediately followed by a low surrogate.
+          if (not raw.starts_with("\\u")) { return false; }
+          raw.remove_prefix(2);
+          int32_t low = consume_code_unit(raw);
+          if (low < 0xdc00 or low >= 0xe000) { return false; }
+          code_point = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+        } else if (unit >= 0xdc00 and unit < 0xe000) {
+          return false;
+        }
+        append_utf8(code_point, out);
+        break;
+      }
+      default: return false;
+    }
+  }
+}
+
+}  // namespace nth::internal_json
@@ -0,0 +1,382 @@
+#ifndef NTH_FORMAT_JSON_PARSE_H
+#define NTH_FORMAT_JSON_PARSE_H
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "nth/container/stack.h"
+#include "nth/format/internal/json_index.h"
+#include "nth/io/reader/reader.h"
+#include "nth/types/reflect.h"
+
+// This header provides a parser for JSON, the inverse of `nth::json_formatter`.
+// Parsing happens in two stages. The first stage scans the input in 64-byte
+// blocks, building an index of the offset of every structurally significant
+// byte. The second stage walks only the index, validating the grammar and
+// reporting each value either to an event handler (`nth::json_parse`) or
+// directly into a C++ object (`nth::json_deserialize`).
+
+namespace nth {
+
+// A `json_handler` receives events from `nth::json_parse` in document order.
+// Strings passed to `string` and `key` have had their escape sequences decoded.
+// They refer either into the parsed input or into a buffer owned by the
+// parser, and are valid only for the duration of the call. Numbers are passed
+// to `number` as their validated lexeme so that handlers may choose how (and
+// whether) to convert them without loss of precision.
+template <typename H>
+concept json_handler = requires(H h, bool b, std::string_view s) {
+  h.null();
+  h.boolean(b);
+  h.number(s);
+  h.string(s);
+  h.key(s);
+  h.begin_object();
+  h.end_object();
+  h.begin_array();
+  h.end_array();
+};
+
+namespace internal_json {
+
+inline constexpr bool type_is_deserializable = false;
+
+template <typename T>
+concept optional_type = requires { typename T::value_type; } and
+                        std::same_as<T, std::optional<typename T::value_type>>;
+
+// Decodes the contents of the string token `raw` into `result`. When `raw`
+// contains no escape sequences, `result` refers directly into the input and no
+// copy is made. Otherwise the decoded string is stored in `scratch`.
+inline bool decode(std::string_view raw, std::string& scratch,
+                   std::string_view& result) {
+  if (raw.find('\\') == std::string_view::npos) {
+    result = raw;
+    return true;
+  }
+  scratch.clear();
+  if (not internal_json::unescape(raw, scratch)) { return false; }
+  result = scratch;
+  return true;
+}
+
+template <json_handler H>
+bool emit_scalar(std::string_view text, H& handler) {
+  if (text == "true") {
+    handler.boolean(true);
+  } else if (text == "false") {
+    handler.boolean(false);
+  } else if (text == "null") {
+    handler.null();
+  } else if (internal_json::valid_number(text)) {
+    handler.number(text);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+template <io::reader R>
+void read_all(R& r, std::string& s) {
+  if constexpr (io::sized_reader<R>) { s.reserve(r.bytes_remaining()); }
+  size_t bytes_read;
+  do {
+    size_t size  = s.size();
+    size_t chunk = s.capacity() - size < 4096 ? 4096 : s.capacity() - size;
+    s.resize(size + chunk);
+    bytes_read = r.read(std::span<std::byte>(
+                            reinterpret_cast<std::byte*>(s.data() + size),
+                            chunk))
+                     .bytes_read();
+    s.resize(size + bytes_read);
+  } while (bytes_read != 0);
+}
+
+// Parses the single value beginning with `t`, consuming exactly the tokens that
+// make it up, and invokes the corresponding member functions on `handler` as
+// `nth::json_parse` does. Strings with escape sequences are decoded into
+// `scratch`.
+template <json_handler H>
+bool parse_value(tokenizer& tokens, token t, std::string& scratch, H& handler) {
+  std::string_view s;
+  nth::stack<token::kind_type, 32> nesting;
+  enum { value, key, after_value } state = value;
+  while (true) {
+    if (state == value) {
+      switch (t.kind) {
+        case token::begin_object:
+          handler.begin_object();
+          t = tokens.next();
+          if (t.kind == token::end_object) {
+            handler.end_object();
+            state = after_value;
+          } else {
+            nesting.push(token::begin_object);
+            state = key;
+          }
+          break;
+        case token::begin_array:
+          handler.begin_array();
+          t = tokens.next();
+          if (t.kind == token::end_array) {
+            handler.end_array();
+            state = after_value;
+          } else {
+            nesting.push(token::begin_array);
+          }
+          break;
+        case token::string:
+          if (not decode(t.text, scratch, s)) { return false; }
+          handler.string(s);
+          state = after_value;
+          break;
+        case token::scalar:
+          if (not emit_scalar(t.text, handler)) { return false; }
+          state = after_value;
+          break;
+        default: return false;
+      }
+    } else if (state == key) {
+      if (t.kind != token::string or not decode(t.text, scratch, s)) {
+        return false;
+      }
+      handler.key(s);
+      if (tokens.next().kind != token::colon) { return false; }
+      t     = tokens.next();
+      state = value;
+    } else {
+      if (nesting.empty()) { return true; }
+      t = tokens.next();
+      if (t.kind == token::comma) {
+        t     = tokens.next();
+        state = (nesting.top() == token::begin_object) ? key : value;
+      } else if (nesting.top() == token::begin_object and
+                 t.kind == token::end_object) {
+        nesting.pop();
+        handler.end_object();
+      } else if (nesting.top() == token::begin_array and
+                 t.kind == token::end_array) {
+        nesting.pop();
+        handler.end_array();
+      } else {
+        return false;
+      }
+    }
+  }
+}
+
+// A `json_handler` which ignores every event, for validating values which are
+// not otherwise needed.
+struct ignoring_handler {
+  void null() {}
+  void boolean(bool) {}
+  void number(std::string_view) {}
+  void string(std::string_view) {}
+  void key(std::string_view) {}
+  void begin_object() {}
+  void end_object() {}
+  void begin_array() {}
+  void end_array() {}
+};
+
+struct deserializer {
+  explicit deserializer(tokenizer& tokens) : tokens_(tokens) {}
+
+  template <typename T>
+  bool read(token t, T& out) {
+    if constexpr (std::same_as<T, bool>) {
+      if (t.kind != token::scalar) { return false; }
+      if (t.text == "true") {
+        out = true;
+      } else if (t.text == "false") {
+        out = false;
+      } else {
+        return false;
+      }
+      return true;
+    } else if constexpr (std::integral<T> or std::floating_point<T>) {
+      if (t.kind != token::scalar or not internal_json::valid_number(t.text)) {
+        return false;
+      }
+      char const* end = t.text.data() + t.text.size();
+      auto [ptr, ec]  = std::from_chars(t.text.data(), end, out);
+      return ec == std::errc() and ptr == end;
+    } else if constexpr (std::same_as<T, std::string>) {
+      if (t.kind != token::string) { return false; }
+      out.clear();
+      return internal_json::unescape(t.text, out);
+    } else if constexpr (optional_type<T>) {
+      if (t.kind == token::scalar and t.text == "null") {
+        out.reset();
+        return true;
+      }
+      return read(t, out.emplace());
+    } else if constexpr (requires {
+                           typename T::key_type;
+                           typename T::mapped_type;
+                         }) {
+      return read_associative(t, out);
+    } else if constexpr (requires(typename T::value_type v) {
+                           out.push_back(std::move(v));
+                         }) {
+      return read_sequence(t, out);
+    } else if constexpr (nth::reflectable<T>) {
+      return read_object(t, out);
+    } else {
+      static_assert(type_is_deserializable);
+      return false;
+    }
+  }
+
+  // Consumes the value beginning with `t` without storing it anywhere,
+  // validating it exactly as `nth::json_parse` would.
+  bool skip(token t) {
+    ignoring_handler handler;
+    return parse_value(tokens_, t, key_scratch_, handler);
+  }
+
+ private:
+  // Reads the key and colon of an object member, returning `false` if they
+  // are not present.
+  bool read_key(token t, std::string_view& key) {
+    return t.kind == token::string and
+           internal_json::decode(t.text, key_scratch_, key) and
+           tokens_.next().kind == token::colon;
+  }
+
+  template <typename T>
+  bool read_sequence(token t, T& out) {
+    if (t.kind != token::begin_array) { return false; }
+    out.clear();
+    t = tokens_.next();
+    if (t.kind == token::end_array) { return true; }
+    while (true) {
+      // Read separately rather than into `out.emplace_back()`, which for
+      // `std::vector<bool>` is a proxy rather than a reference.
+      typename T::value_type v;
+      if (not read(t, v)) { return false; }
+      out.push_back(std::move(v));
+      t = tokens_.next();
+      if (t.kind == token::end_array) { return true; }
+      if (t.kind != token::comma) { return false; }
+      t = tokens_.next();
+    }
+  }
+
+  template <typename T>
+  bool read_associative(token t, T& out) {
+    if (t.kind != token::begin_object) { return false; }
+    out.clear();
+    t = tokens_.next();
+    if (t.kind == token::end_object) { return true; }
+    while (true) {
+      std::string_view key;
+      if (not read_key(t, key)) { return false; }
+      typename T::key_type k(key);
+      typename T::mapped_type v;
+      if (not read(tokens_.next(), v)) { return false; }
+      out.insert_or_assign(std::move(k), std::move(v));
+      t = tokens_.next();
+      if (t.kind == token::end_object) { return true; }
+      if (t.kind != token::comma) { return false; }
+      t = tokens_.next();
+    }
+  }
+
+  // Reads an object into the fields of `out` with matching names. Fields
+  // without a corresponding key are left untouched, and keys without a
+  // corresponding field are skipped.
+  template <typename T>
+  bool read_object(token t, T& out) {
+    constexpr int BaseCount = nth::reflect::base_count<T>;
+    auto const& names       = nth::reflect::field_names<BaseCount>(out);
+    if (t.kind != token::begin_object) { return false; }
+    t = tokens_.next();
+    if (t.kind == token::end_object) { return true; }
+    while (true) {
+      std::string_view key;
+      if (not read_key(t, key)) { return false; }
+      token value  = tokens_.next();
+      bool matched = false;
+      bool ok      = true;
+      nth::reflect::on_fields<BaseCount>(out, [&](auto&... fields) {
+        size_t i = 0;
+        matched  = (... or
+                   (names[i++] == key and ((ok = read(value, fields)), true)));
+      });
+      if (not matched) { ok = skip(value); }
+      if (not ok) { return false; }
+      t = tokens_.next();
+      if (t.kind == token::end_object) { return true; }
+      if (t.kind != token::comma) { return false; }
+      t = tokens_.next();
+    }
+  }
+
+  tokenizer& tokens_;
+  std::string key_scratch_;
+};
+
+}  // namespace internal_json
+
+// Parses `input` as a single JSON value, invoking the corresponding member
+// function on `handler` for each value, key, and array or object boundary
+// encountered. Returns whether `input` is valid JSON. If it is not, `handler`
+// may have received events for some prefix of `input`. Inputs larger than
+// 4GiB are rejected.
+template <json_handler H>
+bool json_parse(std::string_view input, H& handler) {
+  std::vector<uint32_t> index;
+  if (not internal_json::structural_index(input, index)) { return false; }
+  internal_json::tokenizer tokens(input, index);
+  std::string scratch;
+  return internal_json::parse_value(tokens, tokens.next(), scratch, handler) and
+         tokens.next().kind == internal_json::token::end;
+}
+
+// Reads the entirety of `r` and parses it as if by `json_parse` above.
+template <io::reader R, json_handler H>
+bool json_parse(R& r, H& handler) {
+  std::string content;
+  internal_json::read_all(r, content);
+  return nth::json_parse(std::string_view(content), handler);
+}
+
+// Parses `input` as a single JSON value and stores it in `out`. Supported types
+// are `bool`, arithmetic types, `std::string`, `std::optional` (where `null`
+// resets the optional), sequences supporting `push_back` (from arrays),
+// associative containers keyed by strings (from objects), and types
+// satisfying `nth::reflectable` (from objects, matching keys to field names).
+// Returns whether `input` is valid JSON whose shape matches `T`. On failure,
+// `out` may have been partially written.
+template <typename T>
+bool json_deserialize(std::string_view input, T& out) {
+  std::vector<uint32_t> index;
+  if (not internal_json::structural_index(input, index)) { return false; }
+  internal_json::tokenizer tokens(input, index);
+  internal_json::deserializer d(tokens);
+  return d.read(tokens.next(), out) and
+         tokens.next().kind == internal_json::token::end;
+}
+
+// Reads the entirety of `r` and deserializes it as if by `json_deserialize`
+// above.
+template <io::reader R, typename T>
+bool json_deserialize(R& r, T& out) {
+  std::string content;
+  internal_json::read_all(r, content);
+  return nth::json_deserialize(std::string_view(content), out);
+}
+
+}  // namespace nth
+
+#endif  // NTH_FORMAT_JSON_PARSE_H
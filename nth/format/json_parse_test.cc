@@ -0,0 +1,200 @@
+#include "nth/format/json_parse.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nth/format/json.h"
+#include "nth/io/reader/string.h"
+#include "nth/test/test.h"
+
+namespace {
+
+// Records each event as a space-separated token so that tests can compare the
+// full event stream against a single string.
+struct recorder {
+  void null() { events += "null "; }
+  void boolean(bool b) { events += b ? "true " : "false "; }
+  void number(std::string_view n) {
+    events += "#";
+    events += n;
+    events += " ";
+  }
+  void string(std::string_view s) {
+    events += "\"";
+    events += s;
+    events += "\" ";
+  }
+  void key(std::string_view k) {
+    events += k;
+    events += ": ";
+  }
+  void begin_object() { events += "{ "; }
+  void end_object() { events += "} "; }
+  void begin_array() { events += "[ "; }
+  void end_array() { events += "] "; }
+
+  std::string events;
+};
+
+std::optional<std::string> events(std::string_view input) {
+  recorder r;
+  if (not nth::json_parse(input, r)) { return std::nullopt; }
+  return r.events;
+}
+
+NTH_TEST("json_parse/primitive") {
+  NTH_EXPECT(events("true") == "true ");
+  NTH_EXPECT(events(" false\n") == "false ");
+  NTH_EXPECT(events("null") == "null ");
+  NTH_EXPECT(events("17") == "#17 ");
+  NTH_EXPECT(events("-0.5e+10") == "#-0.5e+10 ");
+  NTH_EXPECT(events(R"("abc")") == R"("abc" )");
+}
+
+NTH_TEST("json_parse/string-escapes") {
+  NTH_EXPECT(events(R"("a\nb")") == "\"a\nb\" ");
+  NTH_EXPECT(events(R"("\"\\\/")") == R"(""\/" )");
+  NTH_EXPECT(events(R"("\u00e9")") == "\"\u00e9\" ");
+  NTH_EXPECT(events(R"("\ud83d\ude00")") == "\"\U0001F600\" ");
+  NTH_EXPECT(events(R"("\ud83d")") == std::nullopt);
+  NTH_EXPECT(events(R"("\x")") == std::nullopt);
+  NTH_EXPECT(events("\"a\nb\"") == std::nullopt);
+}
+
+NTH_TEST("json_parse/nested") {
+  NTH_EXPECT(events("[]") == "[ ] ");
+  NTH_EXPECT(events("{}") == "{ } ");
+  NTH_EXPECT(events("[1, [2, {}], []]") == "[ #1 [ #2 { } ] [ ] ] ");
+  NTH_EXPECT(events(R"({"a": 1, "b": [true, null]})") ==
+             "{ a: #1 b: [ true null ] } ");
+}
+
+NTH_TEST("json_parse/invalid") {
+  NTH_EXPECT(events("") == std::nullopt);
+  NTH_EXPECT(events("   ") == std::nullopt);
+  NTH_EXPECT(events("[") == std::nullopt);
+  NTH_EXPECT(events("]") == std::nullopt);
+  NTH_EXPECT(events("[1 2]") == std::nullopt);
+  NTH_EXPECT(events("[1,]") == std::nullopt);
+  NTH_EXPECT(events(R"({"a" 1})") == std::nullopt);
+  NTH_EXPECT(events(R"({"a":})") == std::nullopt);
+  NTH_EXPECT(events(R"({"a":1}})") == std::nullopt);
+  NTH_EXPECT(events("{1: 2}") == std::nullopt);
+  NTH_EXPECT(events("01") == std::nullopt);
+  NTH_EXPECT(events("1.") == std::nullopt);
+  NTH_EXPECT(events("truex") == std::nullopt);
+  NTH_EXPECT(events(R"("unterminated)") == std::nullopt);
+}
+
+NTH_TEST("json_parse/spans-blocks") {
+  // Build an input long enough to cross many 64-byte blocks, with strings and
+  // escapes straddling block boundaries.
+  std::string input    = "[";
+  std::string expected = "[ ";
+  for (int i = 0; i < 200; ++i) {
+    std::string n = std::to_string(i);
+    input += n + R"(, "\\\")" + n + R"(",)";
+    expected += "#" + n + " \"\\\"" + n + "\" ";
+  }
+  input += "0]";
+  expected += "#0 ] ";
+  NTH_EXPECT(events(input) == expected);
+}
+
+NTH_TEST("json_parse/reader") {
+  nth::io::string_reader r(R"({"a": [1, 2]})");
+  recorder rec;
+  NTH_ASSERT(nth::json_parse(r, rec));
+  NTH_EXPECT(rec.events == "{ a: [ #1 #2 ] } ");
+}
+
+NTH_TEST("json_deserialize/containers") {
+  std::map<std::string, std::vector<std::optional<int>>> m;
+  NTH_ASSERT(nth::json_deserialize(R"({"x": [1, null, 3], "y": []})", m));
+  NTH_EXPECT(m.size() == size_t{2});
+  NTH_EXPECT(m["x"] ==
+             (std::vector<std::optional<int>>{1, std::nullopt, 3}));
+  NTH_EXPECT(m["y"].empty());
+
+  std::vector<double> d;
+  NTH_ASSERT(nth::json_deserialize("[1.5, -2e3]", d));
+  NTH_EXPECT(d == (std::vector<double>{1.5, -2000}));
+
+  std::vector<bool> b;
+  NTH_ASSERT(nth::json_deserialize("[true, false, true]", b));
+  NTH_EXPECT(b == (std::vector<bool>{true, false, true}));
+
+  std::vector<int> v;
+  NTH_EXPECT(not nth::json_deserialize("[1.5]", v));
+  NTH_EXPECT(not nth::json_deserialize("[1] 2", v));
+}
+
+struct Inner {
+  using nth_reflectable = void;
+  bool flag;
+  std::string name;
+};
+
+struct Outer {
+  using nth_reflectable = void;
+  int n;
+  std::optional<std::string> label;
+  std::vector<Inner> inners;
+};
+
+NTH_TEST("json_deserialize/reflectable") {
+  constexpr std::string_view Input = R"({
+    "unknown": {"nested": [1, {"deeper": []}]},
+    "inners": [{"name": "a\tb", "flag": true}, {"flag": false}],
+    "n": 3
+  })";
+  Outer o{.n = 0, .label = "unchanged"};
+  NTH_ASSERT(nth::json_deserialize(Input, o));
+  NTH_EXPECT(o.n == 3);
+  NTH_EXPECT(o.label == "unchanged");
+  NTH_ASSERT(o.inners.size() == size_t{2});
+  NTH_EXPECT(o.inners[0].flag);
+  NTH_EXPECT(o.inners[0].name == "a\tb");
+  NTH_EXPECT(not o.inners[1].flag);
+  NTH_EXPECT(o.inners[1].name == "");
+
+  NTH_EXPECT(not nth::json_deserialize(R"({"n": "three"})", o));
+}
+
+NTH_TEST("json_deserialize/malformed-unknown-field") {
+  Outer o;
+  NTH_EXPECT(not nth::json_deserialize(
+      R"({"n": 1, "unknown": [1 2 ,, : tru]})", o));
+  NTH_EXPECT(not nth::json_deserialize(R"({"unknown": [1, 01]})", o));
+  NTH_EXPECT(not nth::json_deserialize(R"({"unknown": {"a" 1}})", o));
+  NTH_EXPECT(not nth::json_deserialize(R"({"unknown": {"a": 1,}})", o));
+  NTH_EXPECT(not nth::json_deserialize(R"({"unknown": [{"a": [}]]})", o));
+  NTH_EXPECT(not nth::json_deserialize(R"({"unknown": ["\q"]})", o));
+  NTH_EXPECT(nth::json_deserialize(
+      R"({"unknown": [true, null, -1.5e3, {"a": ["\n"]}], "n": 2})", o));
+  NTH_EXPECT(o.n == 2);
+}
+
+NTH_TEST("json_deserialize/round-trip") {
+  Outer o{.n      = 17,
+          .label  = "label \"quoted\"\n",
+          .inners = {{.flag = true, .name = "x"}, {.flag = false}}};
+  std::string s;
+  nth::io::string_writer w(s);
+  nth::format(w, nth::json_formatter{}, o);
+
+  Outer result;
+  NTH_ASSERT(nth::json_deserialize(s, result));
+  NTH_EXPECT(result.n == o.n);
+  NTH_EXPECT(result.label == o.label);
+  NTH_ASSERT(result.inners.size() == o.inners.size());
+  NTH_EXPECT(result.inners[0].flag == o.inners[0].flag);
+  NTH_EXPECT(result.inners[0].name == o.inners[0].name);
+  NTH_EXPECT(result.inners[1].flag == o.inners[1].flag);
+  NTH_EXPECT(result.inners[1].name == o.inners[1].name);
+}
+
+}  // namespace
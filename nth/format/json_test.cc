@@ -1,6 +1,7 @@
 #include "nth/format/json.h"
 
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -143,4 +144,38 @@ NTH_TEST("format/json/object") {
              "}");
 }
 
+struct Reflected {
+  using nth_reflectable = void;
+  int n;
+  std::string s;
+  std::vector<int> v;
+};
+
+struct ReflectedOptional {
+  using nth_reflectable = void;
+  std::optional<int> n;
+  Reflected r;
+};
+
+NTH_TEST("format/json/reflectable") {
+  NTH_EXPECT(json(Reflected{.n = 3, .s = "hi", .v = {1, 2}}) ==
+             "{\n"
+             "  \"n\": 3,\n"
+             "  \"s\": \"hi\",\n"
+             "  \"v\": [\n"
+             "    1,\n"
+             "    2\n"
+             "  ]\n"
+             "}");
+
+  NTH_EXPECT(json(ReflectedOptional{.n = std::nullopt, .r = {.n = 1}}) ==
+             "{\n"
+             "  \"r\": {\n"
+             "    \"n\": 1,\n"
+             "    \"s\": \"\",\n"
+             "    \"v\": []\n"
+             "  }\n"
+             "}");
+}
+
 }  // namespace
@@ -16,6 +16,7 @@ struct extend_impl;
 template <typename T, typename... Extensions>
 struct extend_impl<T, void (*)(Extensions *...)> : Extensions... {
   using nth_reflectable = void;
+  static constexpr int nth_base_count = 1;
 };
 
 constexpr auto all_extensions(void (*)(), auto p) { return p; }
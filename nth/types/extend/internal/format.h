@@ -24,7 +24,7 @@ struct basic_structural_formatter {
     char close[2];
     int width;
   };
-  nth::stack<nesting> nesting_;
+  nth::stack<nesting, 8> nesting_;
 };
 
 }  // namespace nth::ext::internal_format
@@ -173,6 +173,17 @@ constexpr int field_count() {
   }
 }
 
+template <typename T>
+constexpr int base_count() {
+  if constexpr (requires {
+                  { T::nth_base_count } -> nth::explicitly_convertible_to<int>;
+                }) {
+    return T::nth_base_count;
+  } else {
+    return 0;
+  }
+}
+
 struct parsing_state {
   int bases = 0;
   int depth = 0;
@@ -33,6 +33,12 @@ inline constexpr bool fields_are_countable = false;
 template <reflectable T, int BaseCount>
 constexpr int field_count = internal_reflect::field_count<T, BaseCount>();
 
+// Returns the number of direct base classes of the struct `T`. If the struct
+// contains a static data member named `nth_base_count`, that value is
+// reported. Otherwise, `T` is assumed to have no base classes.
+template <reflectable T>
+constexpr int base_count = internal_reflect::base_count<T>();
+
 template <int BaseCount, int&..., reflectable T>
 std::array<std::string_view, ::nth::reflect::field_count<T, BaseCount>> const&
 field_names(T const& value) {
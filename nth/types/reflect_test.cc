@@ -52,6 +52,18 @@ NTH_TEST("reflect/field_count") {
   NTH_EXPECT(nth::reflect::field_count<MultipleWithBase, 1> == 2);
 }
 
+struct CountedBase : Base {
+  using nth_reflectable               = void;
+  static constexpr int nth_base_count = 1;
+  int n;
+};
+
+NTH_TEST("reflect/base_count") {
+  NTH_EXPECT(nth::reflect::base_count<Empty> == 0);
+  NTH_EXPECT(nth::reflect::base_count<MultipleWithBase> == 0);
+  NTH_EXPECT(nth::reflect::base_count<CountedBase> == 1);
+}
+
 NTH_TEST("reflect/field_names") {
   Empty e;
   NTH_ASSERT(nth::reflect::field_names<0>(e) ==